@@ -47,13 +47,17 @@ usage() {
 
 	printf 'usage: %s -h\n' "$script"
 	printf '       %s --help\n' "$script"
-	printf '       %s [-bD|-dB|-c] [-EfgGHMNPST] [-O OPT_LEVEL] [-k KARATSUBA_LEN]\n' "$script"
+	printf '       %s [-bD|-dB|-c] [-EfgGHMNPRSTV] [-O OPT_LEVEL] [-k KARATSUBA_LEN]\n' "$script"
+	printf '       %s [-t TOOM_LEN] [-n NTT_LEN] [-e NEWTON_LEN]\n' "$script"
 	printf '       %s \\\n' "$script"
 	printf '           [--bc-only --disable-dc|--dc-only --disable-bc|--coverage]    \\\n'
 	printf '           [--debug --disable-extra-math --disable-generated-tests]      \\\n'
 	printf '           [--disable-history --disable-man-pages --disable-nls]         \\\n'
 	printf '           [--disable-prompt --disable-signal-handling --disable-strip]  \\\n'
+	printf '           [--disable-simd --disable-threads]                            \\\n'
 	printf '           [--opt=OPT_LEVEL] [--karatsuba-len=KARATSUBA_LEN]             \\\n'
+	printf '           [--toom-len=TOOM_LEN] [--ntt-len=NTT_LEN]                     \\\n'
+	printf '           [--newton-len=NEWTON_LEN]                                     \\\n'
 	printf '           [--prefix=PREFIX] [--bindir=BINDIR]                           \\\n'
 	printf '           [--datarootdir=DATAROOTDIR] [--datadir=DATADIR]               \\\n'
 	printf '           [--mandir=MANDIR] [--man1dir=MAN1DIR]                         \\\n'
@@ -73,6 +77,10 @@ usage() {
 	printf '    -D, --disable-dc\n'
 	printf '        Disable dc. It is an error if "-d", "--dc-only" "-B", or "--disable-bc"\n'
 	printf '        are specified too.\n'
+	printf '    -e NEWTON_LEN, --newton-len NEWTON_LEN\n'
+	printf '        Set the divisor length at which division switches to Newton\n'
+	printf '        iteration to NEWTON_LEN (default is 32768). It is an error if\n'
+	printf '        NEWTON_LEN is not a number or is less than 16.\n'
 	printf '    -E, --disable-extra-math\n'
 	printf '        Disable extra math. This includes: "$" operator (truncate to integer),\n'
 	printf '        "@" operator (set number of decimal places), and r(x, p) (rounding\n'
@@ -99,6 +107,10 @@ usage() {
 	printf '        It is an error if KARATSUBA_LEN is not a number or is less than 16.\n'
 	printf '    -M, --disable-man-pages\n'
 	printf '        Disable installing manpages.\n'
+	printf '    -n NTT_LEN, --ntt-len NTT_LEN\n'
+	printf '        Set the length at which multiplication switches to the NTT to\n'
+	printf '        NTT_LEN (default is 16384). It is an error if NTT_LEN is not a number\n'
+	printf '        or is less than 16.\n'
 	printf '    -N, --disable-nls\n'
 	printf '        Disable POSIX locale (NLS) support.\n'
 	printf '    -O OPT_LEVEL, --opt OPT_LEVEL\n'
@@ -109,11 +121,21 @@ usage() {
 	printf '        Disables the prompt in the built bc. The prompt will never show up,\n'
 	printf '        or in other words, it will be permanently disabled and cannot be\n'
 	printf '        enabled.\n'
+	printf '    -R, --disable-threads\n'
+	printf '        Disable splitting big multiplications and printing across threads. If\n'
+	printf '        enabled, threads are still only used if asked for at runtime.\n'
 	printf '    -S, --disable-signal-handling\n'
 	printf '        Disable signal handling. On by default.\n'
 	printf '    -T, --disable-strip\n'
 	printf '        Disable stripping symbols from the compiled binary or binaries.\n'
 	printf '        Stripping symbols only happens when debug mode is off.\n'
+	printf '    -t TOOM_LEN, --toom-len TOOM_LEN\n'
+	printf '        Set the Toom-Cook length to TOOM_LEN (default is twice\n'
+	printf '        KARATSUBA_LEN). It is an error if TOOM_LEN is not a number or is\n'
+	printf '        less than KARATSUBA_LEN.\n'
+	printf '    -V, --disable-simd\n'
+	printf '        Disable the vector (AVX2 or AVX-512) kernels for addition,\n'
+	printf '        subtraction, and multiplication, even if the machine has them.\n'
 	printf '    --prefix PREFIX\n'
 	printf '        The prefix to install to. Overrides "$PREFIX" if it exists.\n'
 	printf '        If PREFIX is "/usr", install path will be "/usr/bin".\n'
@@ -304,6 +326,9 @@ bc_only=0
 dc_only=0
 coverage=0
 karatsuba_len=64
+toom_len=""
+ntt_len=16384
+newton_len=32768
 debug=0
 signals=1
 hist=1
@@ -315,8 +340,10 @@ nls=1
 prompt=1
 force=0
 strip_bin=1
+simd=1
+threads=1
 
-while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
+while getopts "bBcdDe:EfgGhHk:Mn:NO:PRSt:TV-" opt; do
 
 	case "$opt" in
 		b) bc_only=1 ;;
@@ -324,6 +351,7 @@ while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
 		c) coverage=1 ;;
 		d) dc_only=1 ;;
 		D) bc_only=1 ;;
+		e) newton_len="$OPTARG" ;;
 		E) extra_math=0 ;;
 		f) force=1 ;;
 		g) debug=1 ;;
@@ -332,11 +360,15 @@ while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
 		H) hist=0 ;;
 		k) karatsuba_len="$OPTARG" ;;
 		M) install_manpages=0 ;;
+		n) ntt_len="$OPTARG" ;;
 		N) nls=0 ;;
 		O) optimization="$OPTARG" ;;
 		P) prompt=0 ;;
+		R) threads=0 ;;
 		S) signals=0 ;;
+		t) toom_len="$OPTARG" ;;
 		T) strip_bin=0 ;;
+		V) simd=0 ;;
 		-)
 			arg="$1"
 			arg="${arg#--}"
@@ -404,6 +436,27 @@ while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
 					fi
 					karatsuba_len="$1"
 					shift ;;
+				toom-len=?*) toom_len="$LONG_OPTARG" ;;
+				toom-len)
+					if [ "$#" -lt 2 ]; then
+						usage "No argument given for '--$arg' option"
+					fi
+					toom_len="$2"
+					shift ;;
+				ntt-len=?*) ntt_len="$LONG_OPTARG" ;;
+				ntt-len)
+					if [ "$#" -lt 2 ]; then
+						usage "No argument given for '--$arg' option"
+					fi
+					ntt_len="$2"
+					shift ;;
+				newton-len=?*) newton_len="$LONG_OPTARG" ;;
+				newton-len)
+					if [ "$#" -lt 2 ]; then
+						usage "No argument given for '--$arg' option"
+					fi
+					newton_len="$2"
+					shift ;;
 				opt=?*) optimization="$LONG_OPTARG" ;;
 				opt)
 					if [ "$#" -lt 2 ]; then
@@ -421,6 +474,8 @@ while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
 				disable-prompt) prompt=0 ;;
 				disable-signal-handling) signals=0 ;;
 				disable-strip) strip_bin=0 ;;
+				disable-simd) simd=0 ;;
+				disable-threads) threads=0 ;;
 				help* | bc-only* | dc-only* | coverage* | debug*)
 					usage "No arg allowed for --$arg option" ;;
 				disable-bc* | disable-dc* | disable-extra-math*)
@@ -429,7 +484,7 @@ while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
 					usage "No arg allowed for --$arg option" ;;
 				disable-man-pages* | disable-nls* | disable-signal-handling*)
 					usage "No arg allowed for --$arg option" ;;
-				disable-strip*)
+				disable-strip* | disable-simd* | disable-threads*)
 					usage "No arg allowed for --$arg option" ;;
 				'') break ;; # "--" terminates argument processing
 				* ) usage "Invalid option $LONG_OPTARG" ;;
@@ -454,6 +509,37 @@ if [ "$karatsuba_len" -lt 16 ]; then
 	usage "KARATSUBA_LEN is less than 16"
 fi
 
+if [ -z "$toom_len" ]; then
+	toom_len=$((karatsuba_len * 2))
+fi
+
+case $toom_len in
+	(*[!0-9]*|'') usage "TOOM_LEN is not a number" ;;
+	(*) ;;
+esac
+
+if [ "$toom_len" -lt "$karatsuba_len" ]; then
+	usage "TOOM_LEN is less than KARATSUBA_LEN"
+fi
+
+case $ntt_len in
+	(*[!0-9]*|'') usage "NTT_LEN is not a number" ;;
+	(*) ;;
+esac
+
+if [ "$ntt_len" -lt 16 ]; then
+	usage "NTT_LEN is less than 16"
+fi
+
+case $newton_len in
+	(*[!0-9]*|'') usage "NEWTON_LEN is not a number" ;;
+	(*) ;;
+esac
+
+if [ "$newton_len" -lt 16 ]; then
+	usage "NEWTON_LEN is less than 16"
+fi
+
 set -e
 
 link="@printf 'No link necessary\\\\n'"
@@ -751,6 +837,45 @@ if [ "$hist" -eq 1 ]; then
 
 fi
 
+if [ "$threads" -eq 1 ]; then
+
+	set +e
+
+	printf 'Testing threads...\n'
+
+	flags="-DBC_ENABLE_THREADS=1 -DBC_ENABLED=$bc -DDC_ENABLED=$dc -DBC_ENABLE_SIGNALS=$signals"
+	flags="$flags -DBC_ENABLE_HISTORY=$hist -DBC_ENABLE_NLS=$nls"
+	flags="$flags -DBC_ENABLE_EXTRA_MATH=$extra_math -I./include/"
+	flags="$flags -D_POSIX_C_SOURCE=200809L -D_XOPEN_SOURCE=700 -pthread"
+
+	"$HOSTCC" $HOSTCFLAGS $flags -c "src/thread.c" -o "$scriptdir/thread.o" > /dev/null 2>&1
+
+	err="$?"
+
+	rm -rf "$scriptdir/thread.o"
+
+	# If this errors, it is probably because of building on Windows,
+	# and threads are not supported on Windows, so disable them.
+	if [ "$err" -ne 0 ]; then
+		printf 'Threads do not work.\n'
+		if [ $force -eq 0 ]; then
+			printf 'Disabling threads...\n'
+			threads=0
+		else
+			printf 'Forcing threads...\n'
+		fi
+	else
+		printf 'Threads work.\n'
+	fi
+
+	set -e
+
+fi
+
+if [ "$threads" -eq 1 ]; then
+	CFLAGS="$CFLAGS -pthread"
+fi
+
 if [ "$extra_math" -eq 1 -a "$bc" -ne 0 ]; then
 	BC_LIB2_O="\$(GEN_DIR)/lib2.o"
 else
@@ -789,8 +914,13 @@ printf 'BC_ENABLE_HISTORY=%s\n' "$hist"
 printf 'BC_ENABLE_EXTRA_MATH=%s\n' "$extra_math"
 printf 'BC_ENABLE_NLS=%s\n' "$nls"
 printf 'BC_ENABLE_PROMPT=%s\n' "$prompt"
+printf 'BC_ENABLE_SIMD=%s\n' "$simd"
+printf 'BC_ENABLE_THREADS=%s\n' "$threads"
 printf '\n'
 printf 'BC_NUM_KARATSUBA_LEN=%s\n' "$karatsuba_len"
+printf 'BC_NUM_TOOM_LEN=%s\n' "$toom_len"
+printf 'BC_NUM_NTT_LEN=%s\n' "$ntt_len"
+printf 'BC_NUM_NEWTON_LEN=%s\n' "$newton_len"
 printf '\n'
 printf 'CC=%s\n' "$CC"
 printf 'CFLAGS=%s\n' "$CFLAGS"
@@ -833,11 +963,16 @@ contents=$(replace "$contents" "HISTORY" "$hist")
 contents=$(replace "$contents" "EXTRA_MATH" "$extra_math")
 contents=$(replace "$contents" "NLS" "$nls")
 contents=$(replace "$contents" "PROMPT" "$prompt")
+contents=$(replace "$contents" "SIMD" "$simd")
+contents=$(replace "$contents" "THREADS" "$threads")
 contents=$(replace "$contents" "BC_LIB_O" "$bc_lib")
 contents=$(replace "$contents" "BC_HELP_O" "$bc_help")
 contents=$(replace "$contents" "DC_HELP_O" "$dc_help")
 contents=$(replace "$contents" "BC_LIB2_O" "$BC_LIB2_O")
 contents=$(replace "$contents" "KARATSUBA_LEN" "$karatsuba_len")
+contents=$(replace "$contents" "TOOM_LEN" "$toom_len")
+contents=$(replace "$contents" "NTT_LEN" "$ntt_len")
+contents=$(replace "$contents" "NEWTON_LEN" "$newton_len")
 
 contents=$(replace "$contents" "NLSPATH" "$NLSPATH")
 contents=$(replace "$contents" "DESTDIR" "$destdir")
@@ -0,0 +1,172 @@
+// Copyright (c) 2018-2019 Gavin D. Howard and contributors.
+// Licensed under the 2-clause BSD license.
+// *** AUTOMATICALLY GENERATED FROM gen/lib2.bc. DO NOT MODIFY. ***
+#if BC_ENABLED && BC_ENABLE_EXTRA_MATH
+#include <bc.h>
+
+const char *bc_lib2_name = "gen/lib2.bc";
+
+const char bc_lib2[] = {
+	100,101,102,105,110,101,32,114,40,120,44,112,41,123,10,97,117,116,111,32,116,
+	44,110,10,105,102,40,120,61,61,48,41,114,101,116,117,114,110,32,120,10,112,
+	61,97,98,115,40,112,41,36,10,110,61,40,120,60,48,41,10,120,61,97,98,115,40,
+	120,41,10,116,61,120,64,112,10,105,102,40,112,60,115,99,97,108,101,40,120,41,
+	38,38,120,45,116,62,61,53,62,62,112,43,49,41,116,43,61,49,62,62,112,10,105,
+	102,40,110,41,116,61,45,116,10,114,101,116,117,114,110,32,116,10,125,10,100,
+	101,102,105,110,101,32,99,101,105,108,40,120,44,112,41,123,10,97,117,116,111,
+	32,116,44,110,10,105,102,40,120,61,61,48,41,114,101,116,117,114,110,32,120,
+	10,112,61,97,98,115,40,112,41,36,10,110,61,40,120,60,48,41,10,120,61,97,98,
+	115,40,120,41,10,116,61,40,120,43,40,57,62,62,112,43,49,41,41,64,112,10,105,
+	102,40,110,41,116,61,45,116,10,114,101,116,117,114,110,32,116,10,125,10,100,
+	101,102,105,110,101,32,102,40,110,41,123,10,97,117,116,111,32,114,10,110,61,
+	97,98,115,40,110,41,36,10,102,111,114,40,114,61,49,59,110,62,49,59,45,45,110,
+	41,114,42,61,110,10,114,101,116,117,114,110,32,114,10,125,10,100,101,102,105,
+	110,101,32,112,101,114,109,40,110,44,107,41,123,10,97,117,116,111,32,102,44,
+	103,44,115,10,105,102,40,107,62,110,41,114,101,116,117,114,110,32,48,10,110,
+	61,97,98,115,40,110,41,36,10,107,61,97,98,115,40,107,41,36,10,102,61,102,40,
+	110,41,10,103,61,102,40,110,45,107,41,10,115,61,115,99,97,108,101,10,115,99,
+	97,108,101,61,48,10,102,47,61,103,10,115,99,97,108,101,61,115,10,114,101,116,
+	117,114,110,32,102,10,125,10,100,101,102,105,110,101,32,99,111,109,98,40,110,
+	44,114,41,123,10,97,117,116,111,32,115,44,102,44,103,44,104,10,105,102,40,114,
+	62,110,41,114,101,116,117,114,110,32,48,10,110,61,97,98,115,40,110,41,36,10,
+	114,61,97,98,115,40,114,41,36,10,115,61,115,99,97,108,101,10,115,99,97,108,
+	101,61,48,10,102,61,102,40,110,41,10,104,61,102,40,114,41,10,103,61,102,40,
+	110,45,114,41,10,102,47,61,104,42,103,10,115,99,97,108,101,61,115,10,114,101,
+	116,117,114,110,32,102,10,125,10,100,101,102,105,110,101,32,108,111,103,40,
+	120,44,98,41,123,10,97,117,116,111,32,112,44,115,10,115,61,115,99,97,108,101,
+	10,105,102,40,115,99,97,108,101,60,75,41,115,99,97,108,101,61,75,10,105,102,
+	40,115,99,97,108,101,40,120,41,62,115,99,97,108,101,41,115,99,97,108,101,61,
+	115,99,97,108,101,40,120,41,10,115,99,97,108,101,42,61,50,10,112,61,108,40,
+	120,41,47,108,40,98,41,10,115,99,97,108,101,61,115,10,114,101,116,117,114,110,
+	32,112,10,125,10,100,101,102,105,110,101,32,108,50,40,120,41,123,114,101,116,
+	117,114,110,32,108,111,103,40,120,44,50,41,125,10,100,101,102,105,110,101,32,
+	108,49,48,40,120,41,123,114,101,116,117,114,110,32,108,111,103,40,120,44,65,
+	41,125,10,100,101,102,105,110,101,32,114,111,111,116,40,120,44,110,41,123,10,
+	97,117,116,111,32,115,44,109,44,114,44,113,44,112,10,105,102,40,110,60,48,41,
+	115,113,114,116,40,110,41,10,110,61,97,98,115,40,110,41,36,10,105,102,40,110,
+	61,61,48,41,120,47,110,10,105,102,40,110,61,61,49,41,114,101,116,117,114,110,
+	32,120,10,105,102,40,110,61,61,50,41,114,101,116,117,114,110,32,115,113,114,
+	116,40,120,41,10,115,61,115,99,97,108,101,10,115,99,97,108,101,61,48,10,105,
+	102,40,120,60,48,38,38,110,37,50,61,61,48,41,115,113,114,116,40,120,41,10,115,
+	99,97,108,101,61,115,43,50,10,109,61,40,120,60,48,41,10,120,61,97,98,115,40,
+	120,41,10,112,61,110,45,49,10,113,61,49,48,94,99,101,105,108,40,40,108,101,
+	110,103,116,104,40,120,36,41,47,110,41,36,44,48,41,10,119,104,105,108,101,40,
+	114,33,61,113,41,123,10,114,61,113,10,113,61,40,112,42,114,43,120,47,114,94,
+	112,41,47,110,10,125,10,105,102,40,109,41,114,61,45,114,10,115,99,97,108,101,
+	61,115,10,114,101,116,117,114,110,32,114,64,115,10,125,10,100,101,102,105,110,
+	101,32,99,98,114,116,40,120,41,123,114,101,116,117,114,110,32,114,111,111,116,
+	40,120,44,51,41,125,10,100,101,102,105,110,101,32,112,105,40,115,41,123,10,
+	97,117,116,111,32,116,44,118,10,105,102,40,115,61,61,48,41,114,101,116,117,
+	114,110,32,51,10,115,61,97,98,115,40,115,41,36,10,116,61,115,99,97,108,101,
+	10,115,99,97,108,101,61,115,43,49,10,118,61,52,42,97,40,49,41,10,115,99,97,
+	108,101,61,116,10,114,101,116,117,114,110,32,118,64,115,10,125,10,100,101,102,
+	105,110,101,32,116,40,120,41,123,10,97,117,116,111,32,115,44,99,44,108,10,108,
+	61,115,99,97,108,101,10,115,99,97,108,101,43,61,50,10,115,61,115,40,120,41,
+	10,99,61,99,40,120,41,10,115,99,97,108,101,61,108,10,114,101,116,117,114,110,
+	32,115,47,99,10,125,10,100,101,102,105,110,101,32,97,50,40,121,44,120,41,123,
+	10,97,117,116,111,32,97,44,112,10,105,102,40,33,120,38,38,33,121,41,121,47,
+	120,10,105,102,40,120,60,61,48,41,123,10,112,61,112,105,40,115,99,97,108,101,
+	43,50,41,10,105,102,40,121,60,48,41,112,61,45,112,10,125,10,105,102,40,120,
+	61,61,48,41,97,61,112,47,50,10,101,108,115,101,123,10,115,99,97,108,101,43,
+	61,50,10,97,61,97,40,121,47,120,41,43,112,10,115,99,97,108,101,45,61,50,10,
+	125,10,114,101,116,117,114,110,32,97,64,115,99,97,108,101,10,125,10,100,101,
+	102,105,110,101,32,115,105,110,40,120,41,123,114,101,116,117,114,110,32,115,
+	40,120,41,125,10,100,101,102,105,110,101,32,99,111,115,40,120,41,123,114,101,
+	116,117,114,110,32,99,40,120,41,125,10,100,101,102,105,110,101,32,97,116,97,
+	110,40,120,41,123,114,101,116,117,114,110,32,97,40,120,41,125,10,100,101,102,
+	105,110,101,32,116,97,110,40,120,41,123,114,101,116,117,114,110,32,116,40,120,
+	41,125,10,100,101,102,105,110,101,32,97,116,97,110,50,40,121,44,120,41,123,
+	114,101,116,117,114,110,32,97,50,40,121,44,120,41,125,10,100,101,102,105,110,
+	101,32,114,50,100,40,120,41,123,10,97,117,116,111,32,114,44,105,44,115,10,115,
+	61,115,99,97,108,101,10,115,99,97,108,101,43,61,53,10,105,61,105,98,97,115,
+	101,10,105,98,97,115,101,61,65,10,114,61,120,42,49,56,48,47,112,105,40,115,
+	99,97,108,101,41,10,105,98,97,115,101,61,105,10,115,99,97,108,101,61,115,10,
+	114,101,116,117,114,110,32,114,64,115,10,125,10,100,101,102,105,110,101,32,
+	100,50,114,40,120,41,123,10,97,117,116,111,32,114,44,105,44,115,10,115,61,115,
+	99,97,108,101,10,115,99,97,108,101,43,61,53,10,105,61,105,98,97,115,101,10,
+	105,98,97,115,101,61,65,10,114,61,120,42,112,105,40,115,99,97,108,101,41,47,
+	49,56,48,10,105,98,97,115,101,61,105,10,115,99,97,108,101,61,115,10,114,101,
+	116,117,114,110,32,114,64,115,10,125,10,100,101,102,105,110,101,32,118,111,
+	105,100,32,111,117,116,112,117,116,40,120,44,98,41,123,10,97,117,116,111,32,
+	99,10,99,61,111,98,97,115,101,10,111,98,97,115,101,61,98,10,120,10,111,98,97,
+	115,101,61,99,10,125,10,100,101,102,105,110,101,32,118,111,105,100,32,104,101,
+	120,40,120,41,123,111,117,116,112,117,116,40,120,44,71,41,125,10,100,101,102,
+	105,110,101,32,118,111,105,100,32,98,105,110,97,114,121,40,120,41,123,111,117,
+	116,112,117,116,40,120,44,50,41,125,10,100,101,102,105,110,101,32,117,98,121,
+	116,101,115,40,120,41,123,10,97,117,116,111,32,112,44,98,44,105,10,98,61,105,
+	98,97,115,101,10,105,98,97,115,101,61,65,10,120,61,97,98,115,40,120,41,36,10,
+	105,61,50,94,56,10,102,111,114,40,112,61,49,59,105,45,49,60,120,59,112,42,61,
+	50,41,123,105,42,61,105,125,10,105,98,97,115,101,61,98,10,114,101,116,117,114,
+	110,32,112,10,125,10,100,101,102,105,110,101,32,115,98,121,116,101,115,40,120,
+	41,123,10,97,117,116,111,32,112,44,98,44,110,44,122,10,122,61,40,120,60,48,
+	41,10,120,61,97,98,115,40,120,41,10,120,61,120,36,10,110,61,117,98,121,116,
+	101,115,40,120,41,10,98,61,105,98,97,115,101,10,105,98,97,115,101,61,65,10,
+	112,61,50,94,40,110,42,56,45,49,41,10,105,102,40,120,62,112,124,124,40,33,122,
+	38,38,120,61,61,112,41,41,110,42,61,50,10,105,98,97,115,101,61,98,10,114,101,
+	116,117,114,110,32,110,10,125,10,100,101,102,105,110,101,32,118,111,105,100,
+	32,111,117,116,112,117,116,95,98,121,116,101,40,120,44,105,41,123,10,97,117,
+	116,111,32,106,44,112,44,121,44,98,10,106,61,105,98,97,115,101,10,105,98,97,
+	115,101,61,65,10,115,61,115,99,97,108,101,10,115,99,97,108,101,61,48,10,120,
+	61,97,98,115,40,120,41,36,10,98,61,120,47,40,50,94,40,105,42,56,41,41,10,98,
+	37,61,50,94,56,10,121,61,108,111,103,40,50,53,54,44,111,98,97,115,101,41,36,
+	10,105,102,40,98,62,49,41,112,61,108,111,103,40,98,44,111,98,97,115,101,41,
+	36,43,49,10,101,108,115,101,32,112,61,98,10,102,111,114,40,105,61,121,45,112,
+	59,105,62,48,59,45,45,105,41,112,114,105,110,116,32,48,10,105,102,40,98,41,
+	112,114,105,110,116,32,98,10,115,99,97,108,101,61,115,10,105,98,97,115,101,
+	61,106,10,125,10,100,101,102,105,110,101,32,118,111,105,100,32,111,117,116,
+	112,117,116,95,117,105,110,116,40,120,44,110,41,123,10,97,117,116,111,32,105,
+	44,98,10,98,61,105,98,97,115,101,10,105,98,97,115,101,61,65,10,102,111,114,
+	40,105,61,110,45,49,59,105,62,61,48,59,45,45,105,41,123,10,111,117,116,112,
+	117,116,95,98,121,116,101,40,120,44,105,41,10,105,102,40,105,41,112,114,105,
+	110,116,34,32,34,10,101,108,115,101,32,112,114,105,110,116,34,92,110,34,10,
+	125,10,105,98,97,115,101,61,98,10,125,10,100,101,102,105,110,101,32,118,111,
+	105,100,32,104,101,120,95,117,105,110,116,40,120,44,110,41,123,10,97,117,116,
+	111,32,111,10,111,61,111,98,97,115,101,10,111,98,97,115,101,61,71,10,111,117,
+	116,112,117,116,95,117,105,110,116,40,120,44,110,41,10,111,98,97,115,101,61,
+	111,10,125,10,100,101,102,105,110,101,32,118,111,105,100,32,98,105,110,97,114,
+	121,95,117,105,110,116,40,120,44,110,41,123,10,97,117,116,111,32,111,10,111,
+	61,111,98,97,115,101,10,111,98,97,115,101,61,50,10,111,117,116,112,117,116,
+	95,117,105,110,116,40,120,44,110,41,10,111,98,97,115,101,61,111,10,125,10,100,
+	101,102,105,110,101,32,118,111,105,100,32,117,105,110,116,110,40,120,44,110,
+	41,123,10,105,102,40,115,99,97,108,101,40,120,41,41,123,10,112,114,105,110,
+	116,34,69,114,114,111,114,58,32,34,44,120,44,34,32,105,115,32,110,111,116,32,
+	97,110,32,105,110,116,101,103,101,114,46,92,110,34,10,114,101,116,117,114,110,
+	10,125,10,105,102,40,120,60,48,41,123,10,112,114,105,110,116,34,69,114,114,
+	111,114,58,32,34,44,120,44,34,32,105,115,32,110,101,103,97,116,105,118,101,
+	46,92,110,34,10,114,101,116,117,114,110,10,125,10,105,102,40,120,62,61,50,94,
+	40,110,42,56,41,41,123,10,112,114,105,110,116,34,69,114,114,111,114,58,32,34,
+	44,120,44,34,32,99,97,110,110,111,116,32,102,105,116,32,105,110,116,111,32,
+	34,44,110,44,34,32,117,110,115,105,103,110,101,100,32,98,121,116,101,40,115,
+	41,46,92,110,34,10,114,101,116,117,114,110,10,125,10,98,105,110,97,114,121,
+	95,117,105,110,116,40,120,44,110,41,10,104,101,120,95,117,105,110,116,40,120,
+	44,110,41,10,125,10,100,101,102,105,110,101,32,118,111,105,100,32,105,110,116,
+	110,40,120,44,110,41,123,10,97,117,116,111,32,116,10,105,102,40,115,99,97,108,
+	101,40,120,41,41,123,10,112,114,105,110,116,34,69,114,114,111,114,58,32,34,
+	44,120,44,34,32,105,115,32,110,111,116,32,97,110,32,105,110,116,101,103,101,
+	114,46,92,110,34,10,114,101,116,117,114,110,10,125,10,116,61,50,94,40,110,42,
+	56,45,49,41,10,105,102,40,97,98,115,40,120,41,62,61,116,38,38,40,120,62,48,
+	124,124,120,33,61,45,116,41,41,123,10,112,114,105,110,116,32,34,69,114,114,
+	111,114,58,32,34,44,120,44,34,32,99,97,110,110,111,116,32,102,105,116,32,105,
+	110,116,111,32,34,44,110,44,34,32,115,105,103,110,101,100,32,98,121,116,101,
+	40,115,41,46,92,110,34,10,114,101,116,117,114,110,10,125,10,105,102,40,120,
+	60,48,41,120,61,50,94,40,110,42,56,41,45,40,45,120,41,10,98,105,110,97,114,
+	121,95,117,105,110,116,40,120,44,110,41,10,104,101,120,95,117,105,110,116,40,
+	120,44,110,41,10,125,10,100,101,102,105,110,101,32,118,111,105,100,32,117,105,
+	110,116,56,40,120,41,123,117,105,110,116,110,40,120,44,49,41,125,10,100,101,
+	102,105,110,101,32,118,111,105,100,32,105,110,116,56,40,120,41,123,105,110,
+	116,110,40,120,44,49,41,125,10,100,101,102,105,110,101,32,118,111,105,100,32,
+	117,105,110,116,49,54,40,120,41,123,117,105,110,116,110,40,120,44,50,41,125,
+	10,100,101,102,105,110,101,32,118,111,105,100,32,105,110,116,49,54,40,120,41,
+	123,105,110,116,110,40,120,44,50,41,125,10,100,101,102,105,110,101,32,118,111,
+	105,100,32,117,105,110,116,51,50,40,120,41,123,117,105,110,116,110,40,120,44,
+	52,41,125,10,100,101,102,105,110,101,32,118,111,105,100,32,105,110,116,51,50,
+	40,120,41,123,105,110,116,110,40,120,44,52,41,125,10,100,101,102,105,110,101,
+	32,118,111,105,100,32,117,105,110,116,54,52,40,120,41,123,117,105,110,116,110,
+	40,120,44,56,41,125,10,100,101,102,105,110,101,32,118,111,105,100,32,105,110,
+	116,54,52,40,120,41,123,105,110,116,110,40,120,44,56,41,125,10,100,101,102,
+	105,110,101,32,118,111,105,100,32,117,105,110,116,40,120,41,123,117,105,110,
+	116,110,40,120,44,117,98,121,116,101,115,40,120,41,41,125,10,100,101,102,105,
+	110,101,32,118,111,105,100,32,105,110,116,40,120,41,123,105,110,116,110,40,
+	120,44,115,98,121,116,101,115,40,120,41,41,125,10,0
+};
+#endif // BC_ENABLED && BC_ENABLE_EXTRA_MATH
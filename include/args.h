@@ -40,6 +40,7 @@
 #include <vm.h>
 
 BcStatus bc_args(int argc, char *argv[]);
+size_t bc_args_threads(const char *str);
 
 extern const char* const bc_args_env_name;
 
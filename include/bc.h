@@ -42,6 +42,7 @@
 #include <stdbool.h>
 
 #include <status.h>
+#include <num.h>
 #include <lex.h>
 #include <parse.h>
 
@@ -55,6 +56,19 @@ extern const char bc_lib2[];
 extern const char* bc_lib2_name;
 #endif // BC_ENABLE_EXTRA_MATH
 
+typedef BcStatus (*BcLibFunc)(BcNum**, BcNum*, size_t);
+
+BcStatus bc_lib_e(BcNum **args, BcNum *restrict res, size_t scale);
+BcStatus bc_lib_l(BcNum **args, BcNum *restrict res, size_t scale);
+BcStatus bc_lib_s(BcNum **args, BcNum *restrict res, size_t scale);
+BcStatus bc_lib_c(BcNum **args, BcNum *restrict res, size_t scale);
+BcStatus bc_lib_a(BcNum **args, BcNum *restrict res, size_t scale);
+BcStatus bc_lib_j(BcNum **args, BcNum *restrict res, size_t scale);
+
+extern const char bc_lib_fns[];
+extern const uchar bc_lib_calls[];
+extern const BcLibFunc bc_lib_natives[];
+
 typedef struct BcLexKeyword {
 	uchar data;
 	const char name[9];
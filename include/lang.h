@@ -207,9 +207,16 @@ typedef struct BcLoc {
 typedef struct BcConst {
 	char *val;
 	BcBigDig base;
+	size_t borrows;
 	BcNum num;
 } BcConst;
 
+typedef struct BcConstRef {
+	size_t func;
+	size_t idx;
+	bool borrowed;
+} BcConstRef;
+
 typedef struct BcFunc {
 
 	BcVec code;
@@ -258,6 +265,7 @@ typedef union BcResultData {
 	BcNum n;
 	BcVec v;
 	BcLoc loc;
+	BcConstRef c;
 } BcResultData;
 
 typedef struct BcResult {
@@ -293,8 +301,10 @@ void bc_array_copy(BcVec *d, const BcVec *s);
 void bc_string_free(void *string);
 void bc_const_free(void *constant);
 void bc_id_free(void *id);
+BcConst* bc_result_const(const BcConstRef *c);
 void bc_result_copy(BcResult *d, BcResult *src);
 void bc_result_free(void *result);
+void bc_result_moved(BcResult *r);
 
 void bc_array_expand(BcVec *a, size_t len);
 int bc_id_cmp(const BcId *e1, const BcId *e2);
@@ -305,5 +315,9 @@ extern const char* bc_inst_names[];
 
 extern const char bc_func_main[];
 extern const char bc_func_read[];
+#if BC_ENABLED
+extern const char bc_func_gcd[];
+extern const char bc_func_lcm[];
+#endif // BC_ENABLED
 
 #endif // BC_LANG_H
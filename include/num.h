@@ -45,11 +45,16 @@
 #include <sys/types.h>
 
 #include <status.h>
+#include <vector.h>
 
 #ifndef BC_ENABLE_EXTRA_MATH
 #define BC_ENABLE_EXTRA_MATH (1)
 #endif // BC_ENABLE_EXTRA_MATH
 
+#ifndef BC_ENABLE_SIMD
+#define BC_ENABLE_SIMD (1)
+#endif // BC_ENABLE_SIMD
+
 #define BC_BASE (10)
 
 typedef unsigned long ulong;
@@ -78,6 +83,11 @@ typedef uint_fast64_t BcBigDig;
 #define BC_BASE_DIGS (9)
 #define BC_BASE_POW (1000000000)
 #define BC_NUM_DEF_SIZE (2)
+#define BC_NUM_INLINE_SIZE (4)
+
+typedef uint_least32_t BcBinDig;
+
+#define BC_NUM_BIN_BITS (32)
 
 #define BC_NUM_BIGDIG_C UINT64_C
 
@@ -91,6 +101,11 @@ typedef uint_fast32_t BcBigDig;
 #define BC_BASE_DIGS (4)
 #define BC_BASE_POW (10000)
 #define BC_NUM_DEF_SIZE (4)
+#define BC_NUM_INLINE_SIZE (8)
+
+typedef uint_least16_t BcBinDig;
+
+#define BC_NUM_BIN_BITS (16)
 
 #define BC_NUM_BIGDIG_C UINT32_C
 
@@ -100,6 +115,10 @@ typedef uint_fast32_t BcBigDig;
 
 #endif // BC_LONG_BIT >= 64
 
+// Binary limbs are half as wide as a BcBigDig, so the product of two, plus two
+// more, still fits in one. They are only used for pure integer work.
+#define BC_NUM_BIN_MASK ((((BcBigDig) 1) << BC_NUM_BIN_BITS) - 1)
+
 typedef struct BcNum {
 	BcDig *restrict num;
 	size_t rdx;
@@ -107,6 +126,17 @@ typedef struct BcNum {
 	size_t len;
 	size_t cap;
 	bool neg;
+
+	// Scratch numbers can have their digits in the VM's arena instead. Those
+	// are not freed, and they move to the heap if the number grows.
+	bool tmp;
+
+	// Numbers of up to BC_NUM_INLINE_SIZE limbs keep them here, and num points
+	// to them, until they grow. Such a number can only be copied bytewise with
+	// bc_num_move() or bc_num_swap(), or fixed with BC_NUM_MOVED() after its
+	// bytes were moved, as vectors do.
+	bool inl;
+	BcDig digs[BC_NUM_INLINE_SIZE];
 } BcNum;
 
 #define BC_NUM_MIN_BASE (BC_NUM_BIGDIG_C(2))
@@ -122,6 +152,74 @@ typedef struct BcNum {
 #error BC_NUM_KARATSUBA_LEN must be at least 16.
 #endif // BC_NUM_KARATSUBA_LEN
 
+#ifndef BC_NUM_TOOM_LEN
+#define BC_NUM_TOOM_LEN (BC_NUM_BIGDIG_C(128))
+#elif BC_NUM_TOOM_LEN < BC_NUM_KARATSUBA_LEN
+#error BC_NUM_TOOM_LEN must be at least BC_NUM_KARATSUBA_LEN.
+#endif // BC_NUM_TOOM_LEN
+
+#ifndef BC_NUM_SHORT_LEN
+#define BC_NUM_SHORT_LEN (BC_NUM_BIGDIG_C(1024))
+#endif // BC_NUM_SHORT_LEN
+
+// The NTT pads its operands to a power of two, so below this it loses to
+// Toom-3 for at least some lengths. configure.sh can change it.
+#ifndef BC_NUM_NTT_LEN
+#define BC_NUM_NTT_LEN (BC_NUM_BIGDIG_C(16384))
+#elif BC_NUM_NTT_LEN < 16
+#error BC_NUM_NTT_LEN must be at least 16.
+#endif // BC_NUM_NTT_LEN
+
+#ifndef BC_NUM_BZ_LEN
+#define BC_NUM_BZ_LEN (BC_NUM_BIGDIG_C(32))
+#elif BC_NUM_BZ_LEN < 16
+#error BC_NUM_BZ_LEN must be at least 16.
+#endif // BC_NUM_BZ_LEN
+
+#ifndef BC_NUM_NEWTON_LEN
+#define BC_NUM_NEWTON_LEN (BC_NUM_BIGDIG_C(32768))
+#elif BC_NUM_NEWTON_LEN < 16
+#error BC_NUM_NEWTON_LEN must be at least 16.
+#endif // BC_NUM_NEWTON_LEN
+
+#ifndef BC_NUM_PRINT_LEN
+#define BC_NUM_PRINT_LEN (BC_NUM_BIGDIG_C(64))
+#elif BC_NUM_PRINT_LEN < 16
+#error BC_NUM_PRINT_LEN must be at least 16.
+#endif // BC_NUM_PRINT_LEN
+
+#ifndef BC_NUM_PARSE_LEN
+#define BC_NUM_PARSE_LEN (BC_NUM_BIGDIG_C(256))
+#elif BC_NUM_PARSE_LEN < 16
+#error BC_NUM_PARSE_LEN must be at least 16.
+#endif // BC_NUM_PARSE_LEN
+
+#ifndef BC_NUM_MONT_LEN
+#define BC_NUM_MONT_LEN (BC_NUM_BIGDIG_C(768))
+#endif // BC_NUM_MONT_LEN
+
+#ifndef BC_NUM_THREAD_LEN
+#define BC_NUM_THREAD_LEN (BC_NUM_BIGDIG_C(1024))
+#elif BC_NUM_THREAD_LEN < 16
+#error BC_NUM_THREAD_LEN must be at least 16.
+#endif // BC_NUM_THREAD_LEN
+
+// The NTT primes all have 2^23 as a factor of p - 1, and 3 as a primitive root.
+#define BC_NUM_NTT_PRIMES (3)
+#define BC_NUM_NTT_ROOT (UINT32_C(3))
+#define BC_NUM_NTT_MAX ((size_t) 1 << 23)
+
+// The NTT works on words of 8 or 9 decimal digits, so small BcDig's are packed
+// in pairs. The product of the primes is big enough for any coefficient of a
+// product of BC_NUM_NTT_MAX words of 9 digits.
+#if BC_BASE_DIGS >= 8
+#define BC_NUM_NTT_PACK (1)
+#define BC_NUM_NTT_BASE ((uint64_t) BC_BASE_POW)
+#else // BC_BASE_DIGS >= 8
+#define BC_NUM_NTT_PACK (2)
+#define BC_NUM_NTT_BASE (((uint64_t) BC_BASE_POW) * BC_BASE_POW)
+#endif // BC_BASE_DIGS >= 8
+
 // A crude, but always big enough, calculation of
 // the size required for ibase and obase BcNum's.
 #define BC_NUM_BIGDIG_LOG10 ((CHAR_BIT * sizeof(BcBigDig) + 1) / 2 + 1)
@@ -134,6 +232,11 @@ typedef struct BcNum {
 
 #define BC_NUM_KARATSUBA_ALLOCS (6)
 
+// The most products of two limbs that can be added up in a BcBigDig.
+#define BC_NUM_MUL_TERMS \
+	((size_t) (BC_NUM_BIGDIG_MAX / \
+	           (((BcBigDig) (BC_BASE_POW - 1)) * (BC_BASE_POW - 1))))
+
 #define BC_NUM_CMP_SIGNAL_VAL (~((ssize_t) ((size_t) SSIZE_MAX)))
 #define BC_NUM_CMP_SIGNAL(cmp) (cmp == BC_NUM_CMP_SIGNAL_VAL)
 
@@ -142,6 +245,14 @@ typedef struct BcNum {
 
 #define BC_NUM_SIZE(n) ((n) * sizeof(BcDig))
 
+#define BC_NUM_MOVED(n) ((n)->num = ((n)->inl ? (n)->digs : (n)->num))
+// A number with inline digits points into them, at the start unless zero limbs
+// were shifted off of it. This is false if its bytes were copied without fixing
+// it.
+#define BC_NUM_INL_OK(n) \
+	(!(n)->inl || ((n)->num >= (n)->digs && \
+	               (n)->num <= (n)->digs + BC_NUM_INLINE_SIZE))
+
 #if BC_DEBUG_CODE
 #define BC_NUM_PRINT(x) fprintf(stderr, "%s = %lu\n", #x, (unsigned long)(x))
 #define DUMP_NUM bc_num_dump
@@ -156,10 +267,62 @@ typedef size_t (*BcNumBinaryOpReq)(const BcNum*, const BcNum*, size_t);
 typedef void (*BcNumDigitOp)(size_t, size_t, bool);
 typedef BcStatus (*BcNumShiftAddOp)(BcDig*, const BcDig*, size_t);
 
+// Sets the integers p, q, and a for term k of a series: term k is term k - 1
+// times p / q, and it is multiplied by a in the sum. Term 0 needs p = q = 1.
+typedef BcStatus (*BcNumTermOp)(size_t, const void*, BcNum*, BcNum*, BcNum*);
+
+// The kernels return how many limbs (or products) they took care of, and the
+// plain loops finish the rest.
+typedef size_t (*BcNumCarryOp)(BcDig*, const BcDig*, const BcDig*, size_t,
+                               bool*);
+typedef size_t (*BcNumColumnOp)(const BcDig*, const BcDig*, size_t,
+                                BcBigDig*, BcBigDig*);
+
+typedef struct BcNumKernels {
+	const char *name;
+	BcNumCarryOp add;
+	BcNumCarryOp sub;
+	BcNumColumnOp mul;
+} BcNumKernels;
+
+const BcNumKernels* bc_num_kernels(const char *name);
+
+// These are the pieces of a multiplication or a conversion for printing that
+// can run on separate threads: the pointwise products of Karatsuba and
+// Toom-Cook, the transforms for each NTT prime, and the two halves that
+// bc_num_printDC() splits a number into.
+typedef struct BcNumMulTask {
+	BcNum *a;
+	BcNum *b;
+	BcNum *c;
+	BcDig *scratch;
+} BcNumMulTask;
+
+typedef struct BcNumNttTask {
+	const BcNum *a;
+	const BcNum *b;
+	uint32_t *res;
+	uint32_t *fb;
+	uint32_t *roots;
+	size_t n;
+	uint32_t p;
+} BcNumNttTask;
+
+typedef struct BcNumPrintTask {
+	BcNum *n;
+	const BcVec *pows;
+	size_t idx;
+	size_t digs;
+	size_t pad;
+	BcVec stack;
+} BcNumPrintTask;
+
 void bc_num_init(BcNum *restrict n, size_t req);
 void bc_num_setup(BcNum *restrict n, BcDig *restrict num, size_t cap);
 void bc_num_copy(BcNum *d, const BcNum *s);
 void bc_num_createCopy(BcNum *d, const BcNum *s);
+void bc_num_move(BcNum *restrict d, const BcNum *restrict s);
+void bc_num_swap(BcNum *restrict a, BcNum *restrict b);
 void bc_num_createFromBigdig(BcNum *n, BcBigDig val);
 void bc_num_free(void *num);
 
@@ -180,6 +343,12 @@ BcStatus bc_num_places(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 BcStatus bc_num_lshift(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 BcStatus bc_num_rshift(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 #endif // BC_ENABLE_EXTRA_MATH
+#if BC_ENABLED
+BcStatus bc_num_gcd(BcNum *a, BcNum *b, BcNum *c, size_t scale);
+BcStatus bc_num_lcm(BcNum *a, BcNum *b, BcNum *c, size_t scale);
+BcStatus bc_num_series(BcNumTermOp term, const void *data, size_t len,
+                       BcNum *restrict t, BcNum *restrict q);
+#endif // BC_ENABLED
 BcStatus bc_num_sqrt(BcNum *restrict a, BcNum *restrict b, size_t scale);
 BcStatus bc_num_divmod(BcNum *a, BcNum *b, BcNum *c, BcNum *d, size_t scale);
 
@@ -217,5 +386,6 @@ void bc_num_dump(const char *varname, const BcNum *n);
 
 extern const char bc_num_hex_digits[];
 extern const BcBigDig bc_num_pow10[BC_BASE_DIGS + 1];
+extern const uint32_t bc_num_ntt_primes[BC_NUM_NTT_PRIMES];
 
 #endif // BC_NUM_H
@@ -48,7 +48,18 @@
 #define BC_PROG_GLOBALS_SCALE (2)
 #define BC_PROG_GLOBALS_LEN (3)
 
-#define BC_PROG_ONE_CAP (1)
+#if BC_ENABLED
+#define BC_PROG_LIB_LEN (6)
+
+#define BC_PROG_CONST_ATAN1 (0)
+#define BC_PROG_CONST_ATAN02 (1)
+#define BC_PROG_CONST_E (2)
+#define BC_PROG_CONST_LN2 (3)
+#define BC_PROG_CONST_LN10 (4)
+#define BC_PROG_CONSTS_LEN (5)
+
+#define BC_PROG_CONST_SCALES (4)
+#endif // BC_ENABLED
 
 typedef struct BcProgram {
 
@@ -80,6 +91,14 @@ typedef struct BcProgram {
 
 #if BC_ENABLED
 	BcNum last;
+
+	// The indices of the math library functions that run natively, or 0 if
+	// the library is not loaded or the function was redefined.
+	size_t lib[BC_PROG_LIB_LEN];
+
+	// The values of a(1), a(.2), e(1), l(2), and l(10) from the last few
+	// scales that the native math library needed them at.
+	BcVec consts[BC_PROG_CONSTS_LEN];
 #endif // BC_ENABLED
 
 #if DC_ENABLED
@@ -88,8 +107,6 @@ typedef struct BcProgram {
 	BcDig strmb_num[BC_NUM_BIGDIG_LOG10];
 #endif // DC_ENABLED
 
-	BcDig one_num[BC_PROG_ONE_CAP];
-
 } BcProgram;
 
 #define BC_PROG_STACK(s, n) ((s)->len >= ((size_t) (n)))
@@ -148,6 +165,9 @@ BcStatus bc_program_printStackDebug(BcProgram* p);
 size_t bc_program_search(BcProgram *p, char* id, bool var);
 void bc_program_addFunc(BcProgram *p, BcFunc *f, const char* name);
 size_t bc_program_insertFunc(BcProgram *p, char *name);
+#if BC_ENABLED
+void bc_program_lib(BcProgram *p);
+#endif // BC_ENABLED
 BcStatus bc_program_reset(BcProgram *p, BcStatus s);
 BcStatus bc_program_exec(BcProgram *p);
 
@@ -0,0 +1,94 @@
+/*
+ * *****************************************************************************
+ *
+ * Copyright (c) 2018-2019 Gavin D. Howard and contributors.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * Definitions for the thread pool that big multiplications are split across.
+ *
+ */
+
+#ifndef BC_THREAD_H
+#define BC_THREAD_H
+
+#ifndef BC_ENABLE_THREADS
+#define BC_ENABLE_THREADS (1)
+#endif // BC_ENABLE_THREADS
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <status.h>
+
+// This is the most threads that --threads and BC_THREADS can ask for.
+#define BC_THREAD_MAX (256)
+
+typedef BcStatus (*BcThreadFunc)(void *data);
+
+#if BC_ENABLE_THREADS
+
+#ifdef _WIN32
+#error Threads are not supported on Windows.
+#endif
+
+#include <pthread.h>
+
+typedef struct BcThreadTask {
+
+	BcThreadFunc func;
+	void *data;
+
+	BcStatus s;
+	bool done;
+
+	struct BcThreadTask *next;
+
+} BcThreadTask;
+
+typedef struct BcThreadPool {
+
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+
+	BcThreadTask *tasks;
+
+	pthread_t *threads;
+	size_t len;
+
+	bool stop;
+
+} BcThreadPool;
+
+void bc_thread_init(BcThreadPool *p, size_t threads);
+void bc_thread_free(BcThreadPool *p);
+BcStatus bc_thread_run(BcThreadPool *p, BcThreadTask *tasks, size_t len);
+
+#endif // BC_ENABLE_THREADS
+
+#endif // BC_THREAD_H
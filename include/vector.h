@@ -73,8 +73,9 @@ void bc_vec_string(BcVec *restrict v, size_t len, const char *restrict str);
 void bc_vec_concat(BcVec *restrict v, const char *restrict str);
 void bc_vec_empty(BcVec *restrict v);
 
-#if BC_ENABLE_HISTORY
 void bc_vec_popAt(BcVec *restrict v, size_t idx);
+
+#if BC_ENABLE_HISTORY
 void bc_vec_replaceAt(BcVec *restrict v, size_t idx, const void *data);
 #endif // BC_ENABLE_HISTORY
 
@@ -56,6 +56,7 @@
 #include <parse.h>
 #include <program.h>
 #include <history.h>
+#include <thread.h>
 
 #if !BC_ENABLED && !DC_ENABLED
 #error Must define BC_ENABLED, DC_ENABLED, or both
@@ -155,6 +156,25 @@
 
 #define BC_VM_INVALID_CATALOG ((nl_catd) -1)
 
+// Digit buffers are recycled through free lists, one for each power of two
+// from BC_VM_POOL_MIN bytes up. Bigger buffers are not pooled.
+#define BC_VM_POOL_MIN_SHIFT (5)
+#define BC_VM_POOL_MIN ((size_t) 1 << BC_VM_POOL_MIN_SHIFT)
+
+#ifndef BC_VM_POOL_CLASSES
+#define BC_VM_POOL_CLASSES (12)
+#endif // BC_VM_POOL_CLASSES
+
+#define BC_VM_POOL_SIZE(i) (BC_VM_POOL_MIN << (i))
+
+// The scratch arena never grows past this, so one huge statement does not pin
+// that much memory for the rest of the run.
+#ifndef BC_VM_ARENA_MAX
+#define BC_VM_ARENA_MAX ((size_t) 1 << 20)
+#endif // BC_VM_ARENA_MAX
+
+#define BC_VM_ARENA_ALIGN (16)
+
 typedef struct BcVm {
 
 	BcParse prs;
@@ -179,6 +199,18 @@ typedef struct BcVm {
 
 	BcBigDig maxes[BC_PROG_GLOBALS_LEN];
 
+	const BcNumKernels *kernels;
+
+	size_t threads;
+#if BC_ENABLED
+	// The smallest scale at which the math library sums e(1) and a(1/m) by
+	// binary splitting, or SIZE_MAX if it never does.
+	size_t split;
+#endif // BC_ENABLED
+#if BC_ENABLE_THREADS
+	BcThreadPool pool;
+#endif // BC_ENABLE_THREADS
+
 	BcVec files;
 	BcVec exprs;
 
@@ -209,6 +241,24 @@ typedef struct BcVm {
 	nl_catd catalog;
 #endif // BC_ENABLE_NLS
 
+	// Each freed buffer holds the pointer to the next one in its class.
+	void *digs[BC_VM_POOL_CLASSES];
+#if BC_ENABLE_THREADS
+	pthread_mutex_t digs_lock;
+#endif // BC_ENABLE_THREADS
+	// How often each class had a buffer to give, printed at exit if the
+	// *_POOL_STATS environment variable exists.
+	size_t digs_hits[BC_VM_POOL_CLASSES];
+	size_t digs_misses[BC_VM_POOL_CLASSES];
+	bool digs_stats;
+
+	// Scratch digits for division, square roots, and printing are bumped off of
+	// this. What did not fit sizes it the next time it is empty.
+	char *arena;
+	size_t arena_len;
+	size_t arena_cap;
+	size_t arena_need;
+
 } BcVm;
 
 #if BC_ENABLED
@@ -217,7 +267,9 @@ BcStatus bc_vm_posixError(BcError e, size_t line, ...);
 
 void bc_vm_info(const char* const help);
 BcStatus bc_vm_boot(int argc, char *argv[], const char *env_len,
-                    const char* const env_args, const char* env_exp_quit);
+                    const char* const env_args, const char* env_exp_quit,
+                    const char *env_threads, const char *env_stats,
+                    const char *env_kernels);
 void bc_vm_shutdown(void);
 
 size_t bc_vm_printf(const char *fmt, ...);
@@ -229,6 +281,12 @@ size_t bc_vm_arraySize(size_t n, size_t size);
 size_t bc_vm_growSize(size_t a, size_t b);
 void* bc_vm_malloc(size_t n);
 void* bc_vm_realloc(void *ptr, size_t n);
+void* bc_vm_poolAlloc(size_t *n);
+void* bc_vm_poolRealloc(void *ptr, size_t old, size_t *n);
+void bc_vm_poolFree(void *ptr, size_t n);
+void* bc_vm_arenaAlloc(size_t *n);
+void bc_vm_arenaRelease(size_t mark);
+void bc_vm_arenaReset(void);
 char* bc_vm_strdup(const char *str);
 
 BcStatus bc_vm_error(BcError e, size_t line, ...);
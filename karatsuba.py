@@ -35,13 +35,14 @@ import time
 def usage():
 	print("usage: {} [test_num exe]".format(script))
 	print("\n    test_num is the last Karatsuba number to run through tests")
+	print("    (the Toom-Cook and NTT numbers are only tuned when test_num is 0)")
 	sys.exit(1)
 
 script = sys.argv[0]
 testdir = os.path.dirname(script)
 
 print("\nWARNING: This script is for distro and package maintainers.")
-print("It is for finding the optimal Karatsuba number.")
+print("It is for finding the optimal Karatsuba, Toom-Cook, and NTT numbers.")
 print("Though it only needs to be run once per release/platform,")
 print("it takes forever to run.")
 print("You have been warned.\n")
@@ -56,6 +57,16 @@ mn = 16
 
 num = "9" * mx
 
+# The Toom-Cook threshold is in BcDig's, and it is always bigger than the
+# Karatsuba threshold, so it needs much bigger numbers to time.
+toom_mult = 4
+toom_steps = 16
+toom_num = "9" * (mx * toom_mult * 16)
+
+# The NTT threshold is also in BcDig's. The NTT pads its operands to a power of
+# two, so it is timed on products of many sizes, not just one.
+ntt_lens = [ 2048 * i for i in range(1, 17) ]
+
 if len(sys.argv) >= 2:
 	test_num = int(sys.argv[1])
 else:
@@ -72,11 +83,58 @@ indata = "for (i = 0; i < 100; ++i) {} * {}\n"
 indata += "1.23456789^100000\n1.23456789^100000\nhalt"
 indata = indata.format(num, num)
 
+toom_indata = "for (i = 0; i < 10; ++i) {} * {}\n"
+toom_indata += "1.23456789^500000\nhalt"
+toom_indata = toom_indata.format(toom_num, toom_num)
+
+ntt_indata = "for (i = 2000; i <= 40000; i += 2000) {\n"
+ntt_indata += "\ta = 3^(19 * i)\n"
+ntt_indata += "\tfor (j = 0; j < 4; ++j) c = a * (a + 1)\n"
+ntt_indata += "}\nhalt"
+
 times = []
 nums = []
 runs = []
 nruns = 5
 
+def configure_and_make(args):
+
+	print("\nCompiling...\n")
+
+	makecmd = [ "./configure.sh", "-O3" ] + args
+	p = subprocess.run(makecmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+
+	if p.returncode != 0:
+		print("configure.sh returned an error ({}); exiting...".format(p.returncode))
+		sys.exit(p.returncode)
+
+	makecmd = [ "make" ]
+	p = subprocess.run(makecmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+
+	if p.returncode != 0:
+		print("make returned an error ({}); exiting...".format(p.returncode))
+		sys.exit(p.returncode)
+
+def time_runs(data):
+
+	for j in range(0, nruns):
+
+		cmd = [ exe, "{}/tests/bc/power.txt".format(testdir) ]
+
+		start = time.perf_counter()
+		p = subprocess.run(cmd, input=data.encode(), stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+		end = time.perf_counter()
+
+		if p.returncode != 0:
+			print("bc returned an error; exiting...")
+			sys.exit(p.returncode)
+
+		runs[j] = end - start
+
+	run_times = runs[1:]
+
+	return sum(run_times) / len(run_times)
+
 for i in range(0, nruns):
 	runs.append(0)
 
@@ -90,21 +148,7 @@ try:
 
 	for i in range(mn, mx2 + 1):
 
-		print("\nCompiling...\n")
-
-		makecmd = [ "./configure.sh", "-O3", "-k{}".format(i) ]
-		p = subprocess.run(makecmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
-
-		if p.returncode != 0:
-			print("configure.sh returned an error ({}); exiting...".format(p.returncode))
-			sys.exit(p.returncode)
-
-		makecmd = [ "make" ]
-		p = subprocess.run(makecmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
-
-		if p.returncode != 0:
-			print("make returned an error ({}); exiting...".format(p.returncode))
-			sys.exit(p.returncode)
+		configure_and_make([ "-k{}".format(i) ])
 
 		if (test_num >= i):
 
@@ -143,22 +187,7 @@ try:
 
 			print("Timing Karatsuba Num: {}".format(i), end='', flush=True)
 
-			for j in range(0, nruns):
-
-				cmd = [ exe, "{}/tests/bc/power.txt".format(testdir) ]
-
-				start = time.perf_counter()
-				p = subprocess.run(cmd, input=indata.encode(), stdout=subprocess.PIPE, stderr=subprocess.PIPE)
-				end = time.perf_counter()
-
-				if p.returncode != 0:
-					print("bc returned an error; exiting...")
-					sys.exit(p.returncode)
-
-				runs[j] = end - start
-
-			run_times = runs[1:]
-			avg = sum(run_times) / len(run_times)
+			avg = time_runs(indata)
 
 			times.append(avg)
 			nums.append(i)
@@ -173,6 +202,62 @@ if test_num == 0:
 	opt = nums[times.index(min(times))]
 
 	print("\n\nOptimal Karatsuba Num (for this machine): {}".format(opt))
+
+	toom_times = []
+	toom_nums = []
+	toom_step = max(1, (opt * toom_mult - opt) // toom_steps)
+
+	try:
+
+		for i in range(opt, opt * toom_mult + 1, toom_step):
+
+			configure_and_make([ "-k{}".format(opt), "-t{}".format(i) ])
+
+			print("Timing Toom-Cook Num: {}".format(i), end='', flush=True)
+
+			avg = time_runs(toom_indata)
+
+			toom_times.append(avg)
+			toom_nums.append(i)
+			print(", Time: {}".format(avg))
+
+	except KeyboardInterrupt:
+		pass
+
+	if len(toom_times) != 0:
+		toom_opt = toom_nums[toom_times.index(min(toom_times))]
+	else:
+		toom_opt = opt * 2
+
+	print("\n\nOptimal Toom-Cook Num (for this machine): {}".format(toom_opt))
+
+	ntt_times = []
+	ntt_nums = []
+
+	try:
+
+		for i in ntt_lens:
+
+			configure_and_make([ "-k{}".format(opt), "-t{}".format(toom_opt),
+			                     "-n{}".format(i) ])
+
+			print("Timing NTT Num: {}".format(i), end='', flush=True)
+
+			avg = time_runs(ntt_indata)
+
+			ntt_times.append(avg)
+			ntt_nums.append(i)
+			print(", Time: {}".format(avg))
+
+	except KeyboardInterrupt:
+		pass
+
+	if len(ntt_times) != 0:
+		ntt_opt = ntt_nums[ntt_times.index(min(ntt_times))]
+	else:
+		ntt_opt = 16384
+
+	print("\n\nOptimal NTT Num (for this machine): {}".format(ntt_opt))
 	print("Run the following:\n")
-	print("./configure.sh -O3 -k {}".format(opt))
+	print("./configure.sh -O3 -k {} -t {} -n {}".format(opt, toom_opt, ntt_opt))
 	print("make")
@@ -285,6 +285,14 @@ karatsuba() {
 	do_make karatsuba_test
 }
 
+thresholds() {
+
+	header "Running tests with low thresholds"
+
+	build "$release" "$defcc" "-O3 -n16 -e16" "1" "$bits"
+	runtest
+}
+
 vg() {
 
 	header "Running valgrind"
@@ -488,6 +496,7 @@ if [ "$run_tests" -ne 0 ]; then
 	build "$release" "$defcc" "-O3" "1" "$bits"
 
 	karatsuba
+	thresholds
 
 	if [ "$run_valgrind" -ne 0 -a "$test_with_gcc" -ne 0 ]; then
 		vg
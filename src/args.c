@@ -61,6 +61,7 @@ static const struct option bc_args_lopt[] = {
 	{ "standard", no_argument, NULL, 's' },
 	{ "warn", no_argument, NULL, 'w' },
 #endif // BC_ENABLED
+	{ "threads", required_argument, NULL, 't' },
 	{ "version", no_argument, NULL, 'v' },
 #if DC_ENABLED
 	{ "extended-register", no_argument, NULL, 'x' },
@@ -70,11 +71,11 @@ static const struct option bc_args_lopt[] = {
 };
 
 #if !BC_ENABLED
-static const char* const bc_args_opt = "e:f:hiPvVx";
+static const char* const bc_args_opt = "e:f:hiPt:vVx";
 #elif !DC_ENABLED
-static const char* const bc_args_opt = "e:f:ghilPqsvVw";
+static const char* const bc_args_opt = "e:f:ghilPqst:vVw";
 #else // BC_ENABLED && DC_ENABLED
-static const char* const bc_args_opt = "e:f:ghilPqsvVwx";
+static const char* const bc_args_opt = "e:f:ghilPqst:vVwx";
 #endif // BC_ENABLED && DC_ENABLED
 
 static void bc_args_exprs(BcVec *exprs, const char *str) {
@@ -98,6 +99,21 @@ static BcStatus bc_args_file(BcVec *exprs, const char *file) {
 	return s;
 }
 
+size_t bc_args_threads(const char *str) {
+
+	size_t i, len = strlen(str), threads;
+	bool num = (len != 0);
+
+	for (i = 0; num && i < len; ++i) num = (isdigit(str[i]) != 0);
+
+	// The length check keeps strtoul() from overflowing.
+	if (!num || len > 9) return 0;
+
+	threads = (size_t) strtoul(str, NULL, 10);
+
+	return threads <= BC_THREAD_MAX ? threads : 0;
+}
+
 BcStatus bc_args(int argc, char *argv[]) {
 
 	BcStatus s = BC_STATUS_SUCCESS;
@@ -185,6 +201,13 @@ BcStatus bc_args(int argc, char *argv[]) {
 			}
 #endif // BC_ENABLED
 
+			case 't':
+			{
+				vm->threads = bc_args_threads(optarg);
+				if (BC_ERR(!vm->threads)) err = c;
+				break;
+			}
+
 			case 'V':
 			case 'v':
 			{
@@ -219,7 +242,10 @@ BcStatus bc_args(int argc, char *argv[]) {
 		}
 	}
 
-	if (version) bc_vm_info(NULL);
+	if (version) {
+		bc_vm_info(NULL);
+		bc_vm_printf("\nKernels: %s\n", vm->kernels->name);
+	}
 	if (do_exit) exit((int) s);
 	if (vm->exprs.len > 1 || !BC_IS_BC) vm->flags |= BC_FLAG_Q;
 	if (argv[optind] != NULL && !strcmp(argv[optind], "--")) ++optind;
@@ -0,0 +1,1081 @@
+/*
+ * *****************************************************************************
+ *
+ * Copyright (c) 2018-2019 Gavin D. Howard and contributors.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * Native versions of the functions in the math library.
+ *
+ */
+
+#if BC_ENABLED
+
+#include <stdbool.h>
+
+#include <status.h>
+#include <num.h>
+#include <bc.h>
+#include <vm.h>
+
+// These do exactly what the bc code in gen/lib.bc does, operation by operation
+// and at the same scale, so the results are the same down to the last digit.
+// The comments are the lines of bc code that each part does.
+
+static const char bc_lib_atan1[] =
+	".7853981633974483096156608458198757210492923498437764552437361480";
+static const char bc_lib_atan02[] =
+	".1973955598498807583700497651947902934475851037878521015176889402";
+
+static void bc_lib_parse(BcNum *restrict n, const char *restrict val) {
+	// Parsing decimal numbers cannot fail.
+	bc_num_parse(n, val, BC_BASE, false);
+}
+
+static void bc_lib_negate(BcNum *restrict n) {
+	if (BC_NUM_NONZERO(n)) n->neg = !n->neg;
+}
+
+// An assignment to scale fails where the bc code would get an error, but these
+// do not report it; the caller runs the bc code instead, which reports the
+// error from the right function.
+static BcStatus bc_lib_scale(const BcNum *restrict n, size_t *scale) {
+
+	BcBigDig r = 0, max = vm->maxes[BC_PROG_GLOBALS_SCALE];
+	size_t i;
+
+	if (n->neg) return BC_STATUS_ERROR_EXEC;
+
+	for (i = n->len; i > n->rdx;) {
+
+		BcBigDig dig = (BcBigDig) n->num[--i];
+
+		if (r > (max - dig) / BC_BASE_POW) return BC_STATUS_ERROR_EXEC;
+
+		r = r * BC_BASE_POW + dig;
+	}
+
+	*scale = (size_t) r;
+
+	return BC_STATUS_SUCCESS;
+}
+
+static BcStatus bc_lib_addScale(size_t *scale, size_t n) {
+	if (n > vm->maxes[BC_PROG_GLOBALS_SCALE] - *scale)
+		return BC_STATUS_ERROR_EXEC;
+	*scale += n;
+	return BC_STATUS_SUCCESS;
+}
+
+static BcStatus bc_lib_sqrt(BcNum *restrict n, size_t scale) {
+
+	BcStatus s;
+	BcNum r;
+
+	s = bc_num_sqrt(n, &r, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+	bc_num_free(n);
+	bc_num_move(n, &r);
+
+	return s;
+}
+
+// If BC_SPLIT_SCALE asks for it, e(1), a(1), and a(1/m) for integer m are
+// summed by binary splitting in bc_num_series() at scales at least vm->split
+// instead, with BC_LIB_GUARD more digits. The results are the true values
+// truncated, which may differ from the bc code in the last digit, because the
+// bc code is not always exact there. That is why this is not the default.
+#define BC_LIB_GUARD (16)
+
+static size_t bc_lib_log10(size_t n) {
+	size_t i;
+	for (i = 0; n >= BC_BASE; ++i) n /= BC_BASE;
+	return i;
+}
+
+static BcStatus bc_lib_mulDig(BcNum *restrict n, BcBigDig d,
+                              BcNum *restrict temp)
+{
+	bc_num_bigdig2num(temp, d);
+	return bc_num_mul(n, temp, n, 0);
+}
+
+// The terms of e, 1 / k!.
+static BcStatus bc_lib_termE(size_t k, const void *data,
+                             BcNum *p, BcNum *q, BcNum *t)
+{
+	BC_UNUSED(data);
+
+	bc_num_one(p);
+	bc_num_one(t);
+
+	if (k) bc_num_bigdig2num(q, (BcBigDig) k);
+	else bc_num_one(q);
+
+	return BC_STATUS_SUCCESS;
+}
+
+// The terms of the Chudnovsky series for 1 / pi. The ratio of term k to term
+// k - 1 is -(6k - 5)(2k - 1)(6k - 1) / (k^3 * 640320^3 / 24), and term k is
+// multiplied by 13591409 + 545140134k. data is 640320^3 / 24.
+static BcStatus bc_lib_termPi(size_t k, const void *data,
+                              BcNum *p, BcNum *q, BcNum *t)
+{
+	BcStatus s;
+	BcBigDig k6 = (BcBigDig) k * 6, k2 = (BcBigDig) k * 2;
+	BcNum temp;
+
+	if (!k) {
+		bc_num_one(p);
+		bc_num_one(q);
+		bc_num_bigdig2num(t, 13591409);
+		return BC_STATUS_SUCCESS;
+	}
+
+	bc_num_init(&temp, BC_NUM_DEF_SIZE);
+
+	bc_num_bigdig2num(p, k6 - 5);
+	s = bc_lib_mulDig(p, k2 - 1, &temp);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_lib_mulDig(p, k6 - 1, &temp);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_lib_negate(p);
+
+	bc_num_bigdig2num(q, (BcBigDig) k);
+	s = bc_num_mul(q, q, &temp, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mul(q, &temp, q, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mul(q, (BcNum*) data, q, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	bc_num_bigdig2num(t, 545140134);
+	s = bc_lib_mulDig(t, (BcBigDig) k, &temp);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_bigdig2num(&temp, 13591409);
+	s = bc_num_add(t, &temp, t, 0);
+
+err:
+	bc_num_free(&temp);
+	return s;
+}
+
+// The terms of Euler's series for atan(1 / m), which is m / (m^2 + 1) times
+// the sum. The ratio of term j to term j - 1 is 2j / ((2j + 1) * (m^2 + 1)).
+// data is m^2 + 1.
+static BcStatus bc_lib_termAtan(size_t j, const void *data,
+                                BcNum *p, BcNum *q, BcNum *t)
+{
+	bc_num_one(t);
+
+	if (!j) {
+		bc_num_one(p);
+		bc_num_one(q);
+		return BC_STATUS_SUCCESS;
+	}
+
+	bc_num_bigdig2num(p, (BcBigDig) j * 2);
+	bc_num_bigdig2num(q, (BcBigDig) j * 2 + 1);
+
+	return bc_num_mul(q, (BcNum*) data, q, 0);
+}
+
+// Sets r to e, with scale digits.
+static BcStatus bc_lib_splitE(BcNum *restrict r, size_t scale) {
+
+	BcStatus s;
+	BcNum q;
+	size_t n, d;
+
+	// The terms stop when k! has more digits than scale.
+	for (n = 1, d = 0; d <= scale + 1; ++n) d += bc_lib_log10(n);
+
+	bc_num_init(&q, BC_NUM_DEF_SIZE);
+
+	s = bc_num_series(bc_lib_termE, NULL, n, r, &q);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	s = bc_num_div(r, &q, r, scale);
+
+err:
+	bc_num_free(&q);
+	return s;
+}
+
+// Sets r to pi, with scale digits. Every term of the Chudnovsky series adds
+// more than 14 digits.
+static BcStatus bc_lib_splitPi(BcNum *restrict r, size_t scale) {
+
+	BcStatus s;
+	BcNum q, c;
+
+	bc_num_init(&q, BC_NUM_DEF_SIZE);
+	bc_num_init(&c, BC_NUM_DEF_SIZE);
+	bc_lib_parse(&c, "10939058860032000");
+
+	s = bc_num_series(bc_lib_termPi, &c, scale / 14 + 2, r, &q);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// pi = 426880 * sqrt(10005) * q / r
+	s = bc_lib_mulDig(&q, 426880, &c);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_bigdig2num(&c, 10005);
+	s = bc_lib_sqrt(&c, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mul(&q, &c, &q, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_div(&q, r, r, scale);
+
+err:
+	bc_num_free(&c);
+	bc_num_free(&q);
+	return s;
+}
+
+// Sets r to atan(1 / m), with scale digits, for an integer m > 0.
+static BcStatus bc_lib_splitAtan(BcNum *restrict r, BcNum *restrict m,
+                                 size_t scale)
+{
+	BcStatus s;
+	BcNum q, v, one;
+	size_t n, digs;
+
+	bc_num_init(&q, BC_NUM_DEF_SIZE);
+	bc_num_init(&v, BC_NUM_DEF_SIZE);
+	bc_num_init(&one, BC_NUM_DEF_SIZE);
+	bc_num_one(&one);
+
+	// v = m^2 + 1
+	s = bc_num_mul(m, m, &v, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(&v, &one, &v, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// Every term adds at least log10(v) digits, which is at least one less
+	// than the number of digits in v, or .3 when v is 2 or 5.
+	digs = bc_num_len(&v) - 1;
+	if (digs) n = scale / digs + 2;
+	else n = scale / 3 * 10 + 2;
+
+	s = bc_num_series(bc_lib_termAtan, &v, n, r, &q);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// atan(1 / m) = m * r / (v * q)
+	s = bc_num_mul(r, m, r, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mul(&q, &v, &q, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_div(r, &q, r, scale);
+
+err:
+	bc_num_free(&one);
+	bc_num_free(&v);
+	bc_num_free(&q);
+	return s;
+}
+
+// The values of a(1), a(.2), e(1), l(2), and l(10) are cached in vm->prog at
+// the last few scales that they were needed at, since s(), c(), a(), and the
+// functions in the second library need them on every call. A value is what
+// the bc code gives at its scale, which is not always the true value
+// truncated, so a value at a bigger scale can only be truncated to give one at
+// a smaller scale when both are summed by binary splitting.
+static bool bc_lib_exact(size_t i, size_t scale) {
+	return i <= BC_PROG_CONST_E && scale >= vm->split;
+}
+
+// Sets res to constant i at scale, negated if neg is true, if it is cached.
+static bool bc_lib_const(size_t i, BcNum *restrict res, size_t scale,
+                         bool neg)
+{
+	BcVec *v = vm->prog.consts + i;
+	BcNum *c, *n = NULL;
+	size_t j;
+
+	for (j = 0; j < v->len; ++j) {
+
+		c = bc_vec_item(v, j);
+
+		if (c->scale == scale) {
+			n = c;
+			break;
+		}
+
+		if (c->scale > scale && bc_lib_exact(i, scale) &&
+		    (n == NULL || c->scale < n->scale))
+		{
+			n = c;
+		}
+	}
+
+	if (n == NULL) return false;
+
+	bc_num_copy(res, n);
+	bc_num_truncate(res, n->scale - scale);
+	if (neg) bc_lib_negate(res);
+
+	return true;
+}
+
+static void bc_lib_setConst(size_t i, const BcNum *restrict n) {
+
+	BcVec *v = vm->prog.consts + i;
+	BcNum c;
+
+	if (v->len == BC_PROG_CONST_SCALES) bc_vec_popAt(v, 0);
+
+	bc_num_createCopy(&c, n);
+	c.neg = false;
+	bc_vec_push(v, &c);
+}
+
+BcStatus bc_lib_e(BcNum **args, BcNum *restrict res, size_t scale) {
+
+	BcStatus s;
+	BcNum x, r, p, f, v, i, t, one;
+	size_t d = 0, sc = scale, c = BC_PROG_CONSTS_LEN;
+	bool n;
+
+	bc_num_createCopy(&x, args[0]);
+	bc_num_init(&r, BC_NUM_DEF_SIZE);
+	bc_num_init(&p, BC_NUM_DEF_SIZE);
+	bc_num_init(&f, BC_NUM_DEF_SIZE);
+	bc_num_init(&v, BC_NUM_DEF_SIZE);
+	bc_num_init(&i, BC_NUM_DEF_SIZE);
+	bc_num_init(&t, BC_NUM_DEF_SIZE);
+	bc_num_init(&one, BC_NUM_DEF_SIZE);
+	bc_num_one(&one);
+
+	// if(x<0){n=1;x=-x}
+	n = x.neg;
+	x.neg = false;
+
+	if (!n && !bc_num_cmp(&x, &one)) {
+
+		if (bc_lib_const(BC_PROG_CONST_E, res, sc, false)) {
+			s = BC_STATUS_SUCCESS;
+			goto err;
+		}
+
+		c = BC_PROG_CONST_E;
+	}
+
+	if (sc >= vm->split && !bc_num_cmp(&x, &one)) {
+		s = bc_lib_addScale(&scale, BC_LIB_GUARD);
+		if (BC_ERR(s)) goto err;
+		s = bc_lib_splitE(&r, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		goto ret;
+	}
+
+	// r=6+s+.44*x
+	bc_num_bigdig2num(&r, 6);
+	bc_num_bigdig2num(&t, (BcBigDig) sc);
+	s = bc_num_add(&r, &t, &r, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_lib_parse(&t, ".44");
+	s = bc_num_mul(&t, &x, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(&r, &t, &r, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// scale=scale(x)+1
+	scale = x.scale;
+	s = bc_lib_addScale(&scale, 1);
+	if (BC_ERR(s)) goto err;
+
+	// while(x>1){d+=1;x/=2;scale+=1}
+	bc_num_bigdig2num(&t, 2);
+	while (BC_NO_SIG && bc_num_cmp(&x, &one) > 0) {
+		d += 1;
+		s = bc_num_div(&x, &t, &x, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_lib_addScale(&scale, 1);
+		if (BC_ERR(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// scale=r
+	s = bc_lib_scale(&r, &scale);
+	if (BC_ERR(s)) goto err;
+
+	// r=x+1
+	s = bc_num_add(&x, &one, &r, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// p=x
+	bc_num_copy(&p, &x);
+
+	// f=v=1
+	bc_num_one(&f);
+	bc_num_one(&v);
+
+	// for(i=2;v;++i){p*=x;f*=i;v=p/f;r+=v}
+	bc_num_bigdig2num(&i, 2);
+	while (BC_NO_SIG && BC_NUM_NONZERO(&v)) {
+		s = bc_num_mul(&p, &x, &p, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_mul(&f, &i, &f, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_div(&p, &f, &v, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&r, &v, &r, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&i, &one, &i, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// while(d--)r*=r
+	for (; BC_NO_SIG && d; --d) {
+		s = bc_num_mul(&r, &r, &r, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+ret:
+	// scale=s
+	// if(n)return(1/r)
+	// return(r/1)
+	if (n) s = bc_num_div(&one, &r, res, sc);
+	else s = bc_num_div(&r, &one, res, sc);
+
+	goto err;
+
+sig:
+	s = BC_STATUS_SIGNAL;
+err:
+	if (BC_NO_ERR(!s) && c < BC_PROG_CONSTS_LEN) bc_lib_setConst(c, res);
+	bc_num_free(&one);
+	bc_num_free(&t);
+	bc_num_free(&i);
+	bc_num_free(&v);
+	bc_num_free(&f);
+	bc_num_free(&p);
+	bc_num_free(&r);
+	bc_num_free(&x);
+	return s;
+}
+
+BcStatus bc_lib_l(BcNum **args, BcNum *restrict res, size_t scale) {
+
+	BcStatus s;
+	BcNum x, r, p, a, q, i, v, t, h, one, two;
+	size_t sc = scale, c = BC_PROG_CONSTS_LEN;
+
+	bc_num_createCopy(&x, args[0]);
+	bc_num_init(&r, BC_NUM_DEF_SIZE);
+	bc_num_init(&p, BC_NUM_DEF_SIZE);
+	bc_num_init(&a, BC_NUM_DEF_SIZE);
+	bc_num_init(&q, BC_NUM_DEF_SIZE);
+	bc_num_init(&i, BC_NUM_DEF_SIZE);
+	bc_num_init(&v, BC_NUM_DEF_SIZE);
+	bc_num_init(&t, BC_NUM_DEF_SIZE);
+	bc_num_init(&h, BC_NUM_DEF_SIZE);
+	bc_num_init(&one, BC_NUM_DEF_SIZE);
+	bc_num_init(&two, BC_NUM_DEF_SIZE);
+	bc_num_one(&one);
+	bc_num_bigdig2num(&two, 2);
+
+	// if(x<=0)return((1-A^scale)/1)
+	if (x.neg || BC_NUM_ZERO(&x)) {
+		bc_num_bigdig2num(&t, BC_BASE);
+		bc_num_bigdig2num(&v, (BcBigDig) scale);
+		s = bc_num_pow(&t, &v, &t, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_sub(&one, &t, &t, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_div(&t, &one, res, scale);
+		goto err;
+	}
+
+	bc_num_bigdig2num(&t, BC_BASE);
+	if (!bc_num_cmp(&x, &two)) c = BC_PROG_CONST_LN2;
+	else if (!bc_num_cmp(&x, &t)) c = BC_PROG_CONST_LN10;
+
+	if (c < BC_PROG_CONSTS_LEN && bc_lib_const(c, res, sc, false)) {
+		c = BC_PROG_CONSTS_LEN;
+		s = BC_STATUS_SUCCESS;
+		goto err;
+	}
+
+	// scale+=6
+	s = bc_lib_addScale(&scale, 6);
+	if (BC_ERR(s)) goto err;
+
+	// p=2
+	bc_num_bigdig2num(&p, 2);
+
+	// while(x>=2){p*=2;x=sqrt(x)}
+	while (BC_NO_SIG && bc_num_cmp(&x, &two) >= 0) {
+		s = bc_num_mul(&p, &two, &p, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_lib_sqrt(&x, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// while(x<=.5){p*=2;x=sqrt(x)}
+	bc_lib_parse(&h, ".5");
+	while (BC_NO_SIG && bc_num_cmp(&x, &h) <= 0) {
+		s = bc_num_mul(&p, &two, &p, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_lib_sqrt(&x, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// r=a=(x-1)/(x+1)
+	s = bc_num_sub(&x, &one, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(&x, &one, &v, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_div(&t, &v, &a, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_copy(&r, &a);
+
+	// q=a*a
+	s = bc_num_mul(&a, &a, &q, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// v=1
+	bc_num_one(&v);
+
+	// for(i=3;v;i+=2){a*=q;v=a/i;r+=v}
+	bc_num_bigdig2num(&i, 3);
+	while (BC_NO_SIG && BC_NUM_NONZERO(&v)) {
+		s = bc_num_mul(&a, &q, &a, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_div(&a, &i, &v, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&r, &v, &r, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&i, &two, &i, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// r*=p
+	s = bc_num_mul(&r, &p, &r, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// scale=s
+	// return(r/1)
+	s = bc_num_div(&r, &one, res, sc);
+
+	goto err;
+
+sig:
+	s = BC_STATUS_SIGNAL;
+err:
+	if (BC_NO_ERR(!s) && c < BC_PROG_CONSTS_LEN) bc_lib_setConst(c, res);
+	bc_num_free(&two);
+	bc_num_free(&one);
+	bc_num_free(&h);
+	bc_num_free(&t);
+	bc_num_free(&v);
+	bc_num_free(&i);
+	bc_num_free(&q);
+	bc_num_free(&a);
+	bc_num_free(&p);
+	bc_num_free(&r);
+	bc_num_free(&x);
+	return s;
+}
+
+BcStatus bc_lib_s(BcNum **args, BcNum *restrict res, size_t scale) {
+
+	BcStatus s;
+	BcNum x, r, a, q, i, t, u, one, two;
+	BcNum *arg = &x;
+	size_t sc = scale;
+
+	bc_num_createCopy(&x, args[0]);
+
+	// if(x<0)return(-s(-x))
+	if (x.neg) {
+		x.neg = false;
+		s = bc_lib_s(&arg, res, scale);
+		if (BC_NO_ERR(!s)) bc_lib_negate(res);
+		bc_num_free(&x);
+		return s;
+	}
+
+	bc_num_init(&r, BC_NUM_DEF_SIZE);
+	bc_num_init(&a, BC_NUM_DEF_SIZE);
+	bc_num_init(&q, BC_NUM_DEF_SIZE);
+	bc_num_init(&i, BC_NUM_DEF_SIZE);
+	bc_num_init(&t, BC_NUM_DEF_SIZE);
+	bc_num_init(&u, BC_NUM_DEF_SIZE);
+	bc_num_init(&one, BC_NUM_DEF_SIZE);
+	bc_num_init(&two, BC_NUM_DEF_SIZE);
+	bc_num_one(&one);
+	bc_num_bigdig2num(&two, 2);
+
+	// scale=1.1*s+2
+	bc_lib_parse(&t, "1.1");
+	bc_num_bigdig2num(&u, (BcBigDig) sc);
+	s = bc_num_mul(&t, &u, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(&t, &two, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_lib_scale(&t, &scale);
+	if (BC_ERR(s)) goto err;
+
+	// a=a(1)
+	arg = &one;
+	s = bc_lib_a(&arg, &a, scale);
+	if (BC_ERR(s)) goto err;
+
+	// scale=0
+	scale = 0;
+
+	// q=(x/a+2)/4
+	s = bc_num_div(&x, &a, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(&t, &two, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_bigdig2num(&u, 4);
+	s = bc_num_div(&t, &u, &q, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// x-=4*q*a
+	s = bc_num_mul(&u, &q, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mul(&t, &a, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_sub(&x, &t, &x, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// if(q%2)x=-x
+	s = bc_num_mod(&q, &two, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	if (BC_NUM_NONZERO(&t)) bc_lib_negate(&x);
+
+	// scale=s+2
+	scale = sc;
+	s = bc_lib_addScale(&scale, 2);
+	if (BC_ERR(s)) goto err;
+
+	// r=a=x
+	bc_num_copy(&a, &x);
+	bc_num_copy(&r, &x);
+
+	// q=-x*x
+	bc_num_copy(&t, &x);
+	bc_lib_negate(&t);
+	s = bc_num_mul(&t, &x, &q, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// for(i=3;a;i+=2){a*=q/(i*(i-1));r+=a}
+	bc_num_bigdig2num(&i, 3);
+	while (BC_NO_SIG && BC_NUM_NONZERO(&a)) {
+		s = bc_num_sub(&i, &one, &t, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_mul(&i, &t, &t, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_div(&q, &t, &t, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_mul(&a, &t, &a, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&r, &a, &r, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&i, &two, &i, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// scale=s
+	// return(r/1)
+	s = bc_num_div(&r, &one, res, sc);
+
+	goto err;
+
+sig:
+	s = BC_STATUS_SIGNAL;
+err:
+	bc_num_free(&two);
+	bc_num_free(&one);
+	bc_num_free(&u);
+	bc_num_free(&t);
+	bc_num_free(&i);
+	bc_num_free(&q);
+	bc_num_free(&a);
+	bc_num_free(&r);
+	bc_num_free(&x);
+	return s;
+}
+
+BcStatus bc_lib_c(BcNum **args, BcNum *restrict res, size_t scale) {
+
+	BcStatus s;
+	BcNum x, t, u, one;
+	BcNum *arg = &one;
+	size_t sc = scale;
+
+	bc_num_init(&x, BC_NUM_DEF_SIZE);
+	bc_num_init(&t, BC_NUM_DEF_SIZE);
+	bc_num_init(&u, BC_NUM_DEF_SIZE);
+	bc_num_init(&one, BC_NUM_DEF_SIZE);
+	bc_num_one(&one);
+
+	// scale*=1.2
+	bc_num_bigdig2num(&t, (BcBigDig) scale);
+	bc_lib_parse(&u, "1.2");
+	s = bc_num_mul(&t, &u, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_lib_scale(&t, &scale);
+	if (BC_ERR(s)) goto err;
+
+	// x=s(2*a(1)+x)
+	s = bc_lib_a(&arg, &t, scale);
+	if (BC_ERR(s)) goto err;
+	bc_num_bigdig2num(&u, 2);
+	s = bc_num_mul(&u, &t, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(&t, args[0], &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	arg = &t;
+	s = bc_lib_s(&arg, &x, scale);
+	if (BC_ERR(s)) goto err;
+
+	// scale=s
+	// return(x/1)
+	s = bc_num_div(&x, &one, res, sc);
+
+err:
+	bc_num_free(&one);
+	bc_num_free(&u);
+	bc_num_free(&t);
+	bc_num_free(&x);
+	return s;
+}
+
+BcStatus bc_lib_a(BcNum **args, BcNum *restrict res, size_t scale) {
+
+	BcStatus s;
+	BcNum x, n, r, a, m, t, f, u, i, k, one, two;
+	BcNum *arg = &k;
+	size_t sc = scale, c = BC_PROG_CONSTS_LEN;
+
+	bc_num_createCopy(&x, args[0]);
+	bc_num_init(&n, BC_NUM_DEF_SIZE);
+	bc_num_init(&r, BC_NUM_DEF_SIZE);
+	bc_num_init(&a, BC_NUM_DEF_SIZE);
+	bc_num_init(&m, BC_NUM_DEF_SIZE);
+	bc_num_init(&t, BC_NUM_DEF_SIZE);
+	bc_num_init(&f, BC_NUM_DEF_SIZE);
+	bc_num_init(&u, BC_NUM_DEF_SIZE);
+	bc_num_init(&i, BC_NUM_DEF_SIZE);
+	bc_num_init(&k, BC_NUM_DEF_SIZE);
+	bc_num_init(&one, BC_NUM_DEF_SIZE);
+	bc_num_init(&two, BC_NUM_DEF_SIZE);
+	bc_num_one(&one);
+	bc_num_bigdig2num(&two, 2);
+	bc_lib_parse(&k, ".2");
+
+	// n=1
+	// if(x<0){n=-1;x=-x}
+	bc_num_one(&n);
+	n.neg = x.neg;
+	x.neg = false;
+
+	// if(scale<65){
+	//   if(x==1){r=.7853.../n;return(r)}
+	//   if(x==.2){r=.1973.../n;return(r)}
+	// }
+	if (scale < 65) {
+
+		const char *val = NULL;
+
+		if (!bc_num_cmp(&x, &one)) val = bc_lib_atan1;
+		else if (!bc_num_cmp(&x, &k)) val = bc_lib_atan02;
+
+		if (val != NULL) {
+			bc_lib_parse(&t, val);
+			s = bc_num_div(&t, &n, res, scale);
+			goto err;
+		}
+	}
+
+	if (!bc_num_cmp(&x, &one)) c = BC_PROG_CONST_ATAN1;
+	else if (!bc_num_cmp(&x, &k)) c = BC_PROG_CONST_ATAN02;
+
+	if (c < BC_PROG_CONSTS_LEN && bc_lib_const(c, res, sc, n.neg)) {
+		c = BC_PROG_CONSTS_LEN;
+		s = BC_STATUS_SUCCESS;
+		goto err;
+	}
+
+	if (sc >= vm->split && BC_NUM_NONZERO(&x) &&
+	    bc_num_cmp(&x, &one) <= 0)
+	{
+
+		// m=1/x, which is exact when x*m==1
+		s = bc_num_div(&one, &x, &m, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_mul(&m, &x, &t, x.scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+		if (!bc_num_cmp(&t, &one)) {
+
+			s = bc_lib_addScale(&scale, BC_LIB_GUARD);
+			if (BC_ERR(s)) goto err;
+
+			// a(1)=pi/4
+			if (!bc_num_cmp(&x, &one)) {
+				s = bc_lib_splitPi(&r, scale);
+				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+				s = bc_lib_mulDig(&n, 4, &t);
+			}
+			else s = bc_lib_splitAtan(&r, &m, scale);
+			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+			s = bc_num_div(&r, &n, res, sc);
+			goto err;
+		}
+
+		bc_num_bigdig2num(&m, 0);
+	}
+
+	// if(x>.2){scale+=5;a=a(.2)}
+	if (bc_num_cmp(&x, &k) > 0) {
+		s = bc_lib_addScale(&scale, 5);
+		if (BC_ERR(s)) goto err;
+		s = bc_lib_a(&arg, &a, scale);
+		if (BC_ERR(s)) goto err;
+	}
+
+	// scale=s+3
+	scale = sc;
+	s = bc_lib_addScale(&scale, 3);
+	if (BC_ERR(s)) goto err;
+
+	// while(x>.2){m+=1;x=(x-.2)/(1+.2*x)}
+	while (BC_NO_SIG && bc_num_cmp(&x, &k) > 0) {
+		s = bc_num_add(&m, &one, &m, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_sub(&x, &k, &t, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_mul(&k, &x, &u, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&one, &u, &u, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_div(&t, &u, &x, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// r=u=x
+	bc_num_copy(&r, &x);
+	bc_num_copy(&u, &x);
+
+	// f=-x*x
+	bc_num_copy(&t, &x);
+	bc_lib_negate(&t);
+	s = bc_num_mul(&t, &x, &f, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// t=1
+	bc_num_one(&t);
+
+	// for(i=3;t;i+=2){u*=f;t=u/i;r+=t}
+	bc_num_bigdig2num(&i, 3);
+	while (BC_NO_SIG && BC_NUM_NONZERO(&t)) {
+		s = bc_num_mul(&u, &f, &u, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_div(&u, &i, &t, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&r, &t, &r, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&i, &two, &i, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// scale=s
+	// return((m*a+r)/n)
+	s = bc_num_mul(&m, &a, &t, sc);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(&t, &r, &t, sc);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_div(&t, &n, res, sc);
+
+	goto err;
+
+sig:
+	s = BC_STATUS_SIGNAL;
+err:
+	if (BC_NO_ERR(!s) && c < BC_PROG_CONSTS_LEN) bc_lib_setConst(c, res);
+	bc_num_free(&two);
+	bc_num_free(&one);
+	bc_num_free(&k);
+	bc_num_free(&i);
+	bc_num_free(&u);
+	bc_num_free(&f);
+	bc_num_free(&t);
+	bc_num_free(&m);
+	bc_num_free(&a);
+	bc_num_free(&r);
+	bc_num_free(&n);
+	bc_num_free(&x);
+	return s;
+}
+
+BcStatus bc_lib_j(BcNum **args, BcNum *restrict res, size_t scale) {
+
+	BcStatus s;
+	BcNum n, a, i, r, v, f, t, u, one;
+	BcNum *x = args[1];
+	size_t sc = scale, len, ascale;
+	bool o = false;
+
+	bc_num_createCopy(&n, args[0]);
+	bc_num_init(&a, BC_NUM_DEF_SIZE);
+	bc_num_init(&i, BC_NUM_DEF_SIZE);
+	bc_num_init(&r, BC_NUM_DEF_SIZE);
+	bc_num_init(&v, BC_NUM_DEF_SIZE);
+	bc_num_init(&f, BC_NUM_DEF_SIZE);
+	bc_num_init(&t, BC_NUM_DEF_SIZE);
+	bc_num_init(&u, BC_NUM_DEF_SIZE);
+	bc_num_init(&one, BC_NUM_DEF_SIZE);
+	bc_num_one(&one);
+
+	// scale=0
+	scale = 0;
+
+	// n/=1
+	s = bc_num_div(&n, &one, &n, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// if(n<0){n=-n;o=n%2}
+	if (n.neg) {
+		n.neg = false;
+		bc_num_bigdig2num(&t, 2);
+		s = bc_num_mod(&n, &t, &t, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		o = BC_NUM_NONZERO(&t);
+	}
+
+	// a=1
+	bc_num_one(&a);
+
+	// for(i=2;i<=n;++i)a*=i
+	bc_num_bigdig2num(&i, 2);
+	while (BC_NO_SIG && bc_num_cmp(&i, &n) <= 0) {
+		s = bc_num_mul(&a, &i, &a, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&i, &one, &i, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// scale=1.5*s
+	bc_lib_parse(&t, "1.5");
+	bc_num_bigdig2num(&u, (BcBigDig) sc);
+	s = bc_num_mul(&t, &u, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_lib_scale(&t, &scale);
+	if (BC_ERR(s)) goto err;
+
+	// a=(x^n)/2^n/a
+	s = bc_num_pow(x, &n, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_bigdig2num(&u, 2);
+	s = bc_num_pow(&u, &n, &u, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_div(&t, &u, &t, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_div(&t, &a, &a, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// r=v=1
+	bc_num_one(&r);
+	bc_num_one(&v);
+
+	// f=-x*x/4
+	bc_num_copy(&t, x);
+	bc_lib_negate(&t);
+	s = bc_num_mul(&t, x, &f, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_bigdig2num(&u, 4);
+	s = bc_num_div(&f, &u, &f, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// scale+=length(a)-scale(a)
+	len = bc_num_len(&a);
+	ascale = bc_num_scale(&a);
+	if (len >= ascale) s = bc_lib_addScale(&scale, len - ascale);
+	else if (ascale - len > scale) s = BC_STATUS_ERROR_EXEC;
+	else scale -= ascale - len;
+	if (BC_ERR(s)) goto err;
+
+	// for(i=1;v;++i){v=v*f/i/(n+i);r+=v}
+	bc_num_one(&i);
+	while (BC_NO_SIG && BC_NUM_NONZERO(&v)) {
+		s = bc_num_mul(&v, &f, &v, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_div(&v, &i, &v, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&n, &i, &t, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_div(&v, &t, &v, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&r, &v, &r, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&i, &one, &i, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+	if (BC_SIG) goto sig;
+
+	// scale=s
+	// if(o)a=-a
+	// return(a*r/1)
+	if (o) bc_lib_negate(&a);
+	s = bc_num_mul(&a, &r, &t, sc);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_div(&t, &one, res, sc);
+
+	goto err;
+
+sig:
+	s = BC_STATUS_SIGNAL;
+err:
+	bc_num_free(&one);
+	bc_num_free(&u);
+	bc_num_free(&t);
+	bc_num_free(&f);
+	bc_num_free(&v);
+	bc_num_free(&r);
+	bc_num_free(&i);
+	bc_num_free(&a);
+	bc_num_free(&n);
+	return s;
+}
+
+#endif // BC_ENABLED
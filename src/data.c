@@ -510,6 +510,10 @@ FILE *bc_history_debug_fp = NULL;
 
 const char bc_func_main[] = "(main)";
 const char bc_func_read[] = "(read)";
+#if BC_ENABLED
+const char bc_func_gcd[] = "gcd";
+const char bc_func_lcm[] = "lcm";
+#endif // BC_ENABLED
 
 #if BC_DEBUG_CODE
 const char* bc_inst_names[] = {
@@ -743,6 +747,15 @@ const BcParseNext bc_parse_next_elem = BC_PARSE_NEXT(1, BC_LEX_RBRACKET);
 const BcParseNext bc_parse_next_for = BC_PARSE_NEXT(1, BC_LEX_SCOLON);
 const BcParseNext bc_parse_next_read =
 	BC_PARSE_NEXT(2, BC_LEX_NLINE, BC_LEX_EOF);
+
+// These are the math library functions that have native versions. Each entry
+// in bc_lib_calls has the bits, by index in bc_lib_fns, of the library
+// functions that the function calls: s() calls a(), and c() calls s() and a().
+const char bc_lib_fns[] = "elscaj";
+const uchar bc_lib_calls[] = { 0, 0, 1 << 4, (1 << 2) | (1 << 4), 0, 0 };
+const BcLibFunc bc_lib_natives[] = {
+	bc_lib_e, bc_lib_l, bc_lib_s, bc_lib_c, bc_lib_a, bc_lib_j,
+};
 #endif // BC_ENABLED
 
 #if DC_ENABLED
@@ -870,6 +883,12 @@ const BcBigDig bc_num_pow10[BC_BASE_DIGS + 1] = {
 #endif // BC_BASE_DIGS > 4
 };
 
+const uint32_t bc_num_ntt_primes[BC_NUM_NTT_PRIMES] = {
+	UINT32_C(167772161),
+	UINT32_C(469762049),
+	UINT32_C(998244353),
+};
+
 const BcNumBinaryOp bc_program_ops[] = {
 	bc_num_pow, bc_num_mul, bc_num_div, bc_num_mod, bc_num_add, bc_num_sub,
 #if BC_ENABLE_EXTRA_MATH
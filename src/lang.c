@@ -182,6 +182,12 @@ void bc_array_expand(BcVec *a, size_t len) {
 	}
 }
 
+BcConst* bc_result_const(const BcConstRef *c) {
+	BcFunc *f = bc_vec_item(&vm->prog.fns, c->func);
+	assert(c->idx < f->consts.len);
+	return bc_vec_item(&f->consts, c->idx);
+}
+
 #if DC_ENABLED
 void bc_result_copy(BcResult *d, BcResult *src) {
 
@@ -211,6 +217,12 @@ void bc_result_copy(BcResult *d, BcResult *src) {
 		}
 
 		case BC_RESULT_CONSTANT:
+		{
+			memcpy(&d->d.c, &src->d.c, sizeof(BcConstRef));
+			if (d->d.c.borrowed) bc_result_const(&d->d.c)->borrows += 1;
+			break;
+		}
+
 		case BC_RESULT_STR:
 		{
 			memcpy(&d->d.n, &src->d.n, sizeof(BcNum));
@@ -237,6 +249,40 @@ void bc_result_copy(BcResult *d, BcResult *src) {
 }
 #endif // DC_ENABLED
 
+void bc_result_moved(BcResult *r) {
+
+	assert(r != NULL);
+
+	switch (r->t) {
+
+		case BC_RESULT_TEMP:
+		case BC_RESULT_IBASE:
+		case BC_RESULT_SCALE:
+		case BC_RESULT_OBASE:
+		{
+			BC_NUM_MOVED(&r->d.n);
+			break;
+		}
+
+		case BC_RESULT_VAR:
+#if BC_ENABLED
+		case BC_RESULT_ARRAY:
+#endif // BC_ENABLED
+		case BC_RESULT_ARRAY_ELEM:
+		case BC_RESULT_STR:
+		case BC_RESULT_CONSTANT:
+		case BC_RESULT_ONE:
+#if BC_ENABLED
+		case BC_RESULT_VOID:
+		case BC_RESULT_LAST:
+#endif // BC_ENABLED
+		{
+			// Do nothing.
+			break;
+		}
+	}
+}
+
 void bc_result_free(void *result) {
 
 	BcResult *r = (BcResult*) result;
@@ -260,7 +306,6 @@ void bc_result_free(void *result) {
 #endif // BC_ENABLED
 		case BC_RESULT_ARRAY_ELEM:
 		case BC_RESULT_STR:
-		case BC_RESULT_CONSTANT:
 		case BC_RESULT_ONE:
 #if BC_ENABLED
 		case BC_RESULT_VOID:
@@ -270,5 +315,15 @@ void bc_result_free(void *result) {
 			// Do nothing.
 			break;
 		}
+
+		case BC_RESULT_CONSTANT:
+		{
+			if (r->d.c.borrowed) {
+				BcConst *c = bc_result_const(&r->d.c);
+				assert(c->borrows);
+				c->borrows -= 1;
+			}
+			break;
+		}
 	}
 }
@@ -43,9 +43,27 @@
 
 #include <status.h>
 #include <num.h>
+#include <thread.h>
 #include <vm.h>
 
-static BcStatus bc_num_m(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale);
+// The vector kernels work on 32-bit limbs, so they need the 64-bit config. On
+// x86-64, they are compiled for their instruction sets whatever the compiler
+// targets, and bc_num_kernels() picks the best one that the CPU has. ARM, both
+// 64-bit and 32-bit, always runs the plain loops.
+#if BC_ENABLE_SIMD && BC_LONG_BIT >= 64 && defined(__GNUC__) && \
+    defined(__x86_64__)
+#include <immintrin.h>
+#define BC_NUM_X86 (1)
+#else
+#define BC_NUM_X86 (0)
+#endif
+
+static BcStatus bc_num_mulDigs(BcNum *a, BcNum *b, BcNum *restrict c,
+                               BcDig *restrict scratch);
+static BcStatus bc_num_d(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale);
+static BcStatus bc_num_printDC(BcNum *restrict n, const BcVec *restrict pows,
+                               size_t idx, size_t digs, size_t pad,
+                               BcVec *restrict stack);
 
 static ssize_t bc_num_neg(size_t n, bool neg) {
 	return (((ssize_t) n) ^ -((ssize_t) neg)) + neg;
@@ -60,11 +78,38 @@ static size_t bc_num_int(const BcNum *n) {
 }
 
 static void bc_num_expand(BcNum *restrict n, size_t req) {
-	assert(n != NULL);
+	assert(n != NULL && BC_NUM_INL_OK(n));
 	req = req >= BC_NUM_DEF_SIZE ? req : BC_NUM_DEF_SIZE;
 	if (req > n->cap) {
-		n->num = bc_vm_realloc(n->num, BC_NUM_SIZE(req));
-		n->cap = req;
+
+		size_t size = BC_NUM_SIZE(req);
+		BcDig *num;
+
+		if (n->inl || n->tmp) {
+			num = bc_vm_poolAlloc(&size);
+			memcpy(num, n->num, BC_NUM_SIZE(n->cap));
+		}
+		else num = bc_vm_poolRealloc(n->num, BC_NUM_SIZE(n->cap), &size);
+
+		n->num = num;
+		n->cap = size / sizeof(BcDig);
+		n->inl = n->tmp = false;
+	}
+}
+
+// Scratch numbers must be dead by the time bc_vm_arenaRelease() is called with
+// the arena's length from before they were made.
+static void bc_num_initTemp(BcNum *restrict n, size_t req) {
+
+	BcDig *num = NULL;
+	size_t size = BC_NUM_SIZE(req);
+
+	if (req > BC_NUM_INLINE_SIZE) num = bc_vm_arenaAlloc(&size);
+
+	if (num == NULL) bc_num_init(n, req);
+	else {
+		bc_num_setup(n, num, size / sizeof(BcDig));
+		n->tmp = true;
 	}
 }
 
@@ -150,13 +195,302 @@ static BcDig bc_num_subDigits(BcDig a, BcDig b, bool *carry) {
 	return a - b;
 }
 
+/**
+ * The plain kernels do nothing, so the loops that follow every call to a
+ * kernel do all of the work.
+ */
+static size_t bc_num_noCarryOp(BcDig *c, const BcDig *a, const BcDig *b,
+                               size_t len, bool *carry)
+{
+	BC_UNUSED(c);
+	BC_UNUSED(a);
+	BC_UNUSED(b);
+	BC_UNUSED(len);
+	BC_UNUSED(carry);
+	return 0;
+}
+
+static size_t bc_num_noColumnOp(const BcDig *a, const BcDig *b, size_t n,
+                                BcBigDig *lo, BcBigDig *hi)
+{
+	BC_UNUSED(a);
+	BC_UNUSED(b);
+	BC_UNUSED(n);
+	BC_UNUSED(lo);
+	BC_UNUSED(hi);
+	return 0;
+}
+
+#if BC_NUM_X86
+
+/**
+ * Returns the mask of the lanes in a block that get a carry (or borrow) from
+ * the lanes that generate one (g) and the lanes that pass one on (p), and
+ * updates carry with the one that comes out of the top lane.
+ */
+static unsigned int bc_num_carries(unsigned int g, unsigned int p,
+                                   unsigned int lanes, bool *carry)
+{
+	// A lane gets a carry if the one below generates one, or if the one below
+	// passes on one that it got. Adding p to the generated carries makes them
+	// ripple through the lanes that pass them on, just like binary addition.
+	unsigned int x = ((g << 1) | *carry) + p;
+
+	*carry = (x >> lanes);
+
+	return (x ^ p) & ((1U << lanes) - 1);
+}
+
+#define BC_NUM_AVX2 __attribute__((target("avx2")))
+#define BC_NUM_AVX512 __attribute__((target("avx2,avx512f")))
+
+BC_NUM_AVX2 static unsigned int bc_num_avx2Lanes(__m256i v) {
+	return (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(v));
+}
+
+BC_NUM_AVX2 static __m256i bc_num_avx2LaneMask(unsigned int x) {
+	const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int) x),
+	                                           bits), bits);
+}
+
+BC_NUM_AVX2 static size_t bc_num_avx2Add(BcDig *c, const BcDig *a,
+                                         const BcDig *b, size_t len,
+                                         bool *carry)
+{
+	size_t i;
+	unsigned int x;
+	__m256i s, m;
+	const __m256i max = _mm256_set1_epi32(BC_BASE_POW - 1);
+	const __m256i base = _mm256_set1_epi32(BC_BASE_POW);
+
+	for (i = 0; BC_NO_SIG && len - i >= 8; i += 8) {
+
+		s = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*) (a + i)),
+		                     _mm256_loadu_si256((const __m256i*) (b + i)));
+
+		x = bc_num_carries(bc_num_avx2Lanes(_mm256_cmpgt_epi32(s, max)),
+		                   bc_num_avx2Lanes(_mm256_cmpeq_epi32(s, max)), 8,
+		                   carry);
+
+		// The lane masks are -1, so subtracting them adds the carries.
+		s = _mm256_sub_epi32(s, bc_num_avx2LaneMask(x));
+		m = _mm256_cmpgt_epi32(s, max);
+		s = _mm256_sub_epi32(s, _mm256_and_si256(m, base));
+
+		_mm256_storeu_si256((__m256i*) (c + i), s);
+	}
+
+	return i;
+}
+
+BC_NUM_AVX2 static size_t bc_num_avx2Sub(BcDig *c, const BcDig *a,
+                                         const BcDig *b, size_t len,
+                                         bool *carry)
+{
+	size_t i;
+	unsigned int x;
+	__m256i d, m;
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i base = _mm256_set1_epi32(BC_BASE_POW);
+
+	for (i = 0; BC_NO_SIG && len - i >= 8; i += 8) {
+
+		d = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*) (a + i)),
+		                     _mm256_loadu_si256((const __m256i*) (b + i)));
+
+		x = bc_num_carries(bc_num_avx2Lanes(_mm256_cmpgt_epi32(zero, d)),
+		                   bc_num_avx2Lanes(_mm256_cmpeq_epi32(d, zero)), 8,
+		                   carry);
+
+		// The lane masks are -1, so adding them subtracts the borrows.
+		d = _mm256_add_epi32(d, bc_num_avx2LaneMask(x));
+		m = _mm256_cmpgt_epi32(zero, d);
+		d = _mm256_add_epi32(d, _mm256_and_si256(m, base));
+
+		_mm256_storeu_si256((__m256i*) (c + i), d);
+	}
+
+	return i;
+}
+
+BC_NUM_AVX2 static size_t bc_num_avx2Mul(const BcDig *a, const BcDig *b,
+                                         size_t n, BcBigDig *lo, BcBigDig *hi)
+{
+	size_t i, t, steps;
+	uint64_t sums[4];
+	__m128i x;
+	__m256i acc, va, vb;
+
+	for (t = 0; n - t >= 4;) {
+
+		steps = BC_MIN((n - t) / 4, BC_NUM_MUL_TERMS);
+
+		// Every lane gets one product per step, so they can all go for
+		// BC_NUM_MUL_TERMS steps before they have to be split.
+		for (acc = _mm256_setzero_si256(), i = 0; i < steps; ++i, t += 4) {
+
+			x = _mm_loadu_si128((const __m128i*) (a + t));
+			va = _mm256_cvtepu32_epi64(x);
+
+			// b goes down, so its limbs are loaded in reverse.
+			x = _mm_loadu_si128((const __m128i*) (b - t - 3));
+			x = _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 1, 2, 3));
+			vb = _mm256_cvtepu32_epi64(x);
+
+			acc = _mm256_add_epi64(acc, _mm256_mul_epu32(va, vb));
+		}
+
+		_mm256_storeu_si256((__m256i*) sums, acc);
+
+		for (i = 0; i < 4; ++i) {
+			*hi += sums[i] / BC_BASE_POW;
+			*lo += sums[i] % BC_BASE_POW;
+		}
+	}
+
+	return t;
+}
+
+// AVX-512 compares straight into bit masks, and it can add to the lanes that a
+// mask picks, so the masks need no conversion.
+BC_NUM_AVX512 static size_t bc_num_avx512Add(BcDig *c, const BcDig *a,
+                                             const BcDig *b, size_t len,
+                                             bool *carry)
+{
+	size_t i;
+	unsigned int x;
+	__m512i s;
+	__mmask16 m;
+	const __m512i one = _mm512_set1_epi32(1);
+	const __m512i max = _mm512_set1_epi32(BC_BASE_POW - 1);
+	const __m512i base = _mm512_set1_epi32(BC_BASE_POW);
+
+	for (i = 0; BC_NO_SIG && len - i >= 16; i += 16) {
+
+		s = _mm512_add_epi32(_mm512_loadu_si512(a + i),
+		                     _mm512_loadu_si512(b + i));
+
+		x = bc_num_carries(_mm512_cmpgt_epi32_mask(s, max),
+		                   _mm512_cmpeq_epi32_mask(s, max), 16, carry);
+
+		s = _mm512_mask_add_epi32(s, (__mmask16) x, s, one);
+		m = _mm512_cmpgt_epi32_mask(s, max);
+		s = _mm512_mask_sub_epi32(s, m, s, base);
+
+		_mm512_storeu_si512(c + i, s);
+	}
+
+	return i;
+}
+
+BC_NUM_AVX512 static size_t bc_num_avx512Sub(BcDig *c, const BcDig *a,
+                                             const BcDig *b, size_t len,
+                                             bool *carry)
+{
+	size_t i;
+	unsigned int x;
+	__m512i d;
+	__mmask16 m;
+	const __m512i one = _mm512_set1_epi32(1);
+	const __m512i zero = _mm512_setzero_si512();
+	const __m512i base = _mm512_set1_epi32(BC_BASE_POW);
+
+	for (i = 0; BC_NO_SIG && len - i >= 16; i += 16) {
+
+		d = _mm512_sub_epi32(_mm512_loadu_si512(a + i),
+		                     _mm512_loadu_si512(b + i));
+
+		x = bc_num_carries(_mm512_cmplt_epi32_mask(d, zero),
+		                   _mm512_cmpeq_epi32_mask(d, zero), 16, carry);
+
+		d = _mm512_mask_sub_epi32(d, (__mmask16) x, d, one);
+		m = _mm512_cmplt_epi32_mask(d, zero);
+		d = _mm512_mask_add_epi32(d, m, d, base);
+
+		_mm512_storeu_si512(c + i, d);
+	}
+
+	return i;
+}
+
+BC_NUM_AVX512 static size_t bc_num_avx512Mul(const BcDig *a, const BcDig *b,
+                                             size_t n, BcBigDig *lo,
+                                             BcBigDig *hi)
+{
+	size_t i, t, steps;
+	uint64_t sums[8];
+	__m256i x;
+	__m512i acc, va, vb;
+	const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+	for (t = 0; n - t >= 8;) {
+
+		steps = BC_MIN((n - t) / 8, BC_NUM_MUL_TERMS);
+
+		for (acc = _mm512_setzero_si512(), i = 0; i < steps; ++i, t += 8) {
+
+			x = _mm256_loadu_si256((const __m256i*) (a + t));
+			va = _mm512_cvtepu32_epi64(x);
+
+			x = _mm256_loadu_si256((const __m256i*) (b - t - 7));
+			vb = _mm512_cvtepu32_epi64(_mm256_permutevar8x32_epi32(x, rev));
+
+			acc = _mm512_add_epi64(acc, _mm512_mul_epu32(va, vb));
+		}
+
+		_mm512_storeu_si512(sums, acc);
+
+		for (i = 0; i < 8; ++i) {
+			*hi += sums[i] / BC_BASE_POW;
+			*lo += sums[i] % BC_BASE_POW;
+		}
+	}
+
+	// The last few products can still fill AVX2 lanes.
+	return t + bc_num_avx2Mul(a + t, b - t, n - t, lo, hi);
+}
+
+#endif // BC_NUM_X86
+
+static const BcNumKernels bc_num_kernelList[] = {
+	{ "scalar", bc_num_noCarryOp, bc_num_noCarryOp, bc_num_noColumnOp },
+#if BC_NUM_X86
+	{ "avx2", bc_num_avx2Add, bc_num_avx2Sub, bc_num_avx2Mul },
+	{ "avx512", bc_num_avx512Add, bc_num_avx512Sub, bc_num_avx512Mul },
+#endif // BC_NUM_X86
+};
+
+const BcNumKernels* bc_num_kernels(const char *name) {
+
+	size_t i, idx = 0;
+
+#if BC_NUM_X86
+	// This checks the OS support for the registers too, not just cpuid.
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) idx = 2;
+	else if (__builtin_cpu_supports("avx2")) idx = 1;
+#endif // BC_NUM_X86
+
+	// The list goes from the oldest to the newest, so a CPU that has a kernel
+	// has all of the ones before it too. Names that are not in the list, or
+	// that need more than the CPU has, are ignored.
+	if (name != NULL) {
+		for (i = 0; i < idx; ++i) {
+			if (!strcmp(name, bc_num_kernelList[i].name)) idx = i;
+		}
+	}
+
+	return bc_num_kernelList + idx;
+}
+
 static BcStatus bc_num_addArrays(BcDig *restrict a, const BcDig *restrict b,
                                  size_t len)
 {
 	size_t i;
 	bool carry = false;
 
-	for (i = 0; BC_NO_SIG && i < len; ++i)
+	for (i = vm->kernels->add(a, a, b, len, &carry); BC_NO_SIG && i < len; ++i)
 		a[i] = bc_num_addDigits(a[i], b[i], &carry);
 
 	for (; BC_NO_SIG && carry; ++i)
@@ -171,7 +505,7 @@ static BcStatus bc_num_subArrays(BcDig *restrict a, const BcDig *restrict b,
 	size_t i;
 	bool carry = false;
 
-	for (i = 0; BC_NO_SIG && i < len; ++i)
+	for (i = vm->kernels->sub(a, a, b, len, &carry); BC_NO_SIG && i < len; ++i)
 		a[i] = bc_num_subDigits(a[i], b[i], &carry);
 
 	for (; BC_NO_SIG && carry; ++i)
@@ -387,7 +721,10 @@ static void bc_num_split(const BcNum *restrict n, size_t idx,
 
 		bc_num_clean(b);
 	}
-	else bc_num_copy(a, n);
+	else {
+		bc_num_copy(a, n);
+		a->neg = false;
+	}
 
 	bc_num_clean(a);
 }
@@ -660,7 +997,8 @@ static BcStatus bc_num_as(BcNum *a, BcNum *b, BcNum *restrict c, size_t sub) {
 	min_len = BC_MIN(len_l, len_r);
 
 	if (do_sub) {
-		for (i = 0; BC_NO_SIG && i < min_len; ++i)
+		i = vm->kernels->sub(ptr_c, ptr_l, ptr_r, min_len, &carry);
+		for (; BC_NO_SIG && i < min_len; ++i)
 			ptr_c[i] = bc_num_subDigits(ptr_l[i], ptr_r[i], &carry);
 		for (; BC_NO_SIG && i < len_l; ++i)
 			ptr_c[i] = bc_num_subDigits(ptr_l[i], 0, &carry);
@@ -670,7 +1008,8 @@ static BcStatus bc_num_as(BcNum *a, BcNum *b, BcNum *restrict c, size_t sub) {
 			ptr_c[i] = bc_num_subDigits(0, 0, &carry);
 	}
 	else {
-		for (i = 0; BC_NO_SIG && i < min_len; ++i)
+		i = vm->kernels->add(ptr_c, ptr_l, ptr_r, min_len, &carry);
+		for (; BC_NO_SIG && i < min_len; ++i)
 			ptr_c[i] = bc_num_addDigits(ptr_l[i], ptr_r[i], &carry);
 		for (; BC_NO_SIG && i < len_l; ++i)
 			ptr_c[i] = bc_num_addDigits(ptr_l[i], 0, &carry);
@@ -697,13 +1036,40 @@ static BcStatus bc_num_as(BcNum *a, BcNum *b, BcNum *restrict c, size_t sub) {
 	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
 }
 
-static BcStatus bc_num_m_simp(const BcNum *a, const BcNum *b, BcNum *restrict c)
+/**
+ * Adds up the products a[t] * b[-t] for t from 0 to n - 1, which make up one
+ * column of a schoolbook product, into *lo and *hi, where the value added is
+ * *hi * BC_BASE_POW + *lo. The products are added up in blocks that cannot
+ * overflow, and each block is only split in two when it ends.
+ */
+static void bc_num_mulColumn(const BcDig *restrict a, const BcDig *restrict b,
+                             size_t n, BcBigDig *restrict lo,
+                             BcBigDig *restrict hi)
+{
+	size_t t, end;
+	BcBigDig sum;
+
+	for (t = vm->kernels->mul(a, b, n, lo, hi); t < n;) {
+
+		end = t + BC_MIN(n - t, BC_NUM_MUL_TERMS);
+
+		for (sum = 0; t < end; ++t)
+			sum += ((BcBigDig) a[t]) * ((BcBigDig) *(b - t));
+
+		*hi += sum / BC_BASE_POW;
+		*lo += sum % BC_BASE_POW;
+	}
+}
+
+// The columns below start are not computed, and neither is their carry, for
+// bc_num_mulShort().
+static BcStatus bc_num_m_simp(const BcNum *a, const BcNum *b, BcNum *restrict c,
+                              size_t start)
 {
 	size_t i, alen = a->len, blen = b->len, clen;
 	BcDig *ptr_a = a->num, *ptr_b = b->num, *ptr_c;
-	BcBigDig sum = 0, carry = 0;
+	BcBigDig lo, hi, carry = 0;
 
-	assert(sizeof(sum) >= sizeof(BcDig) * 2);
 	assert(!a->rdx && !b->rdx);
 
 	clen = bc_vm_growSize(alen, blen);
@@ -712,35 +1078,80 @@ static BcStatus bc_num_m_simp(const BcNum *a, const BcNum *b, BcNum *restrict c)
 	ptr_c = c->num;
 	memset(ptr_c, 0, BC_NUM_SIZE(c->cap));
 
-	for (i = 0; BC_NO_SIG && i < clen; ++i) {
+	for (i = start; BC_NO_SIG && i < clen; ++i) {
 
 		ssize_t sidx = (ssize_t) (i - blen + 1);
 		size_t j = (size_t) BC_MAX(0, sidx), k = BC_MIN(i, blen - 1);
 
-		for (; BC_NO_SIG && j < alen && k < blen; ++j, --k) {
+		lo = carry;
+		hi = 0;
 
-			sum += ((BcBigDig) ptr_a[j]) * ((BcBigDig) ptr_b[k]);
-
-			if (sum >= ((BcBigDig) BC_BASE_POW) * BC_BASE_POW) {
-				carry += sum / BC_BASE_POW;
-				sum %= BC_BASE_POW;
-			}
+		if (j < alen) {
+			bc_num_mulColumn(ptr_a + j, ptr_b + k, BC_MIN(alen - j, k + 1),
+			                 &lo, &hi);
 		}
 
-		if (sum >= BC_BASE_POW) {
-			carry += sum / BC_BASE_POW;
-			sum %= BC_BASE_POW;
-		}
+		ptr_c[i] = (BcDig) (lo % BC_BASE_POW);
+		carry = hi + lo / BC_BASE_POW;
+	}
+
+	if (carry) {
+		assert(carry < BC_BASE_POW);
+		ptr_c[clen] = (BcDig) carry;
+		clen += 1;
+	}
+
+	c->len = clen;
+
+	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+}
+
+static BcStatus bc_num_sqr_simp(const BcNum *a, BcNum *restrict c,
+                                size_t start)
+{
+
+	size_t i, alen = a->len, clen;
+	BcDig *ptr_a = a->num, *ptr_c;
+	BcBigDig lo, hi, carry = 0;
+
+	assert(!a->rdx);
+
+	clen = bc_vm_growSize(alen, alen);
+	bc_num_expand(c, bc_vm_growSize(clen, 1));
+
+	ptr_c = c->num;
+	memset(ptr_c, 0, BC_NUM_SIZE(c->cap));
+
+	// Every cross product a[j] * a[k] with j != k appears twice in column
+	// j + k, so each one is only computed once and the column is doubled
+	// before the square on the diagonal and the carry from the last column are
+	// added.
+	for (i = start; BC_NO_SIG && i < clen; ++i) {
+
+		ssize_t sidx = (ssize_t) (i - alen + 1);
+		size_t j = (size_t) BC_MAX(0, sidx), k = i - j;
+
+		lo = hi = 0;
+
+		if (j < k) bc_num_mulColumn(ptr_a + j, ptr_a + k, (k - j + 1) / 2,
+		                            &lo, &hi);
 
-		ptr_c[i] = (BcDig) sum;
-		assert(ptr_c[i] < BC_BASE_POW);
-		sum = carry;
-		carry = 0;
+		lo *= 2;
+		hi *= 2;
+
+		if (!(i & 1))
+			lo += ((BcBigDig) ptr_a[i / 2]) * ((BcBigDig) ptr_a[i / 2]);
+
+		lo += carry;
+
+		hi += lo / BC_BASE_POW;
+		ptr_c[i] = (BcDig) (lo % BC_BASE_POW);
+		carry = hi;
 	}
 
-	if (sum) {
-		assert(sum < BC_BASE_POW);
-		ptr_c[clen] = (BcDig) sum;
+	if (carry) {
+		assert(carry < BC_BASE_POW);
+		ptr_c[clen] = (BcDig) carry;
 		clen += 1;
 	}
 
@@ -757,14 +1168,123 @@ static BcStatus bc_num_shiftAddSub(BcNum *restrict n, const BcNum *restrict a,
 	return op(n->num + shift, a->num, a->len);
 }
 
-static BcStatus bc_num_k(BcNum *a, BcNum *b, BcNum *restrict c) {
+static size_t bc_num_mulCap(size_t len) {
+	len = BC_MAX(len, BC_NUM_DEF_SIZE);
+	return bc_vm_growSize(bc_vm_arraySize(2, len), 3);
+}
+
+static size_t bc_num_mulScratch(size_t len) {
+
+	size_t max, half, k, size, toom;
+
+	// This is how many BcDig's of scratch space bc_num_k() and bc_num_toom3()
+	// need for operands of len BcDig's, including their recursive calls. The
+	// pieces of an operand can be one BcDig longer than half (or a third) of
+	// it, so the recursive calls are sized for that. The NTT allocates its own.
+	if (len < BC_NUM_KARATSUBA_LEN) return 0;
+
+	max = BC_MAX(len, BC_NUM_DEF_SIZE);
+	half = bc_vm_growSize(max, 1) / 2 + 1;
+
+	size = bc_vm_arraySize(BC_NUM_KARATSUBA_ALLOCS, max);
+	size = bc_vm_growSize(size, bc_vm_arraySize(3, bc_num_mulCap(half)));
+	size = bc_vm_growSize(size, bc_num_mulScratch(half));
+
+	if (len >= BC_NUM_TOOM_LEN) {
+
+		k = bc_vm_growSize(len, 2) / 3 + 2;
+
+		toom = bc_vm_arraySize(7, k);
+		toom = bc_vm_growSize(toom, bc_vm_arraySize(6, bc_num_mulCap(k)));
+		toom = bc_vm_growSize(toom, bc_num_mulScratch(k));
+
+		size = BC_MAX(size, toom);
+	}
+
+	return size;
+}
+
+static bool bc_num_threaded(size_t len) {
+#if BC_ENABLE_THREADS
+	return vm->pool.len != 0 && len >= BC_NUM_THREAD_LEN;
+#else // BC_ENABLE_THREADS
+	BC_UNUSED(len);
+	return false;
+#endif // BC_ENABLE_THREADS
+}
+
+static BcStatus bc_num_tasks(BcThreadFunc f, void *data, size_t size,
+                             size_t len, bool threaded)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	char *ptr = (char*) data;
+	size_t i;
+
+#if BC_ENABLE_THREADS
+	if (threaded && len > 1) {
+
+		BcThreadTask tasks[5];
+
+		assert(len <= sizeof(tasks) / sizeof(BcThreadTask));
+
+		for (i = 0; i < len; ++i) {
+			tasks[i].func = f;
+			tasks[i].data = ptr + i * size;
+		}
+
+		return bc_thread_run(&vm->pool, tasks, len);
+	}
+#else // BC_ENABLE_THREADS
+	BC_UNUSED(threaded);
+#endif // BC_ENABLE_THREADS
+
+	for (i = 0; BC_NO_ERR(!s) && i < len; ++i) s = f(ptr + i * size);
+
+	return s;
+}
+
+static BcStatus bc_num_mulTask(void *data) {
+	BcNumMulTask *t = (BcNumMulTask*) data;
+	return bc_num_mulDigs(t->a, t->b, t->c, t->scratch);
+}
+
+static BcStatus bc_num_mulMany(BcNumMulTask *m, size_t len, size_t max,
+                               BcDig *restrict scratch)
+{
+	BcStatus s;
+	size_t i, size;
+	bool threaded = (len > 1 && bc_num_threaded(max));
+
+	// The products are independent of each other, so when they are big enough,
+	// they are spread across the thread pool. They cannot share scratch space
+	// then, so all but the first get their own.
+	for (i = 0; i < len; ++i) {
+
+		m[i].scratch = scratch;
+
+		if (threaded && i) {
+			size = bc_num_mulScratch(BC_MAX(m[i].a->len, m[i].b->len));
+			m[i].scratch = size ? bc_vm_malloc(BC_NUM_SIZE(size)) : NULL;
+		}
+	}
+
+	s = bc_num_tasks(bc_num_mulTask, m, sizeof(BcNumMulTask), len, threaded);
+
+	for (i = 1; threaded && i < len; ++i) free(m[i].scratch);
 
+	return s;
+}
+
+static BcStatus bc_num_k(BcNum *a, BcNum *b, BcNum *restrict c,
+                         BcDig *restrict scratch)
+{
 	BcStatus s;
-	size_t max, max2, total;
-	BcNum l1, h1, l2, h2, m2, m1, z0, z1, z2, temp;
-	BcDig *digs, *dig_ptr;
+	size_t max, max2, zcap, len;
+	BcNum l1, h1, l2, h2, m2, m1, z0, z1, z2, *pl2, *ph2, *pm2;
+	BcNumMulTask prods[3];
+	BcDig *dig_ptr;
 	BcNumShiftAddOp op;
-	bool aone = BC_NUM_ONE(a);
+	bool aone = BC_NUM_ONE(a), sqr = (a == b);
 
 	assert(BC_NUM_ZERO(c));
 
@@ -777,14 +1297,17 @@ static BcStatus bc_num_k(BcNum *a, BcNum *b, BcNum *restrict c) {
 		return BC_STATUS_SUCCESS;
 	}
 	if (a->len < BC_NUM_KARATSUBA_LEN || b->len < BC_NUM_KARATSUBA_LEN)
-		return bc_num_m_simp(a, b, c);
+		return sqr ? bc_num_sqr_simp(a, c, 0) : bc_num_m_simp(a, b, c, 0);
 
 	max = BC_MAX(a->len, b->len);
 	max = BC_MAX(max, BC_NUM_DEF_SIZE);
 	max2 = (max + 1) / 2;
 
-	total = bc_vm_arraySize(BC_NUM_KARATSUBA_ALLOCS, max);
-	digs = dig_ptr = bc_vm_malloc(BC_NUM_SIZE(total));
+	// All of the pieces and products come out of the scratch space that
+	// bc_num_m() allocated for the whole recursion, and the rest of it is
+	// passed down to the recursive multiplications.
+	zcap = bc_num_mulCap(max2 + 1);
+	dig_ptr = scratch;
 
 	bc_num_setup(&l1, dig_ptr, max);
 	dig_ptr += max;
@@ -797,15 +1320,17 @@ static BcStatus bc_num_k(BcNum *a, BcNum *b, BcNum *restrict c) {
 	bc_num_setup(&m1, dig_ptr, max);
 	dig_ptr += max;
 	bc_num_setup(&m2, dig_ptr, max);
-	max = bc_vm_growSize(max, 1);
-	bc_num_init(&z0, max);
-	bc_num_init(&z1, max);
-	bc_num_init(&z2, max);
-	max = bc_vm_growSize(max, max) + 1;
-	bc_num_init(&temp, max);
+	dig_ptr += max;
+	bc_num_setup(&z0, dig_ptr, zcap);
+	dig_ptr += zcap;
+	bc_num_setup(&z1, dig_ptr, zcap);
+	dig_ptr += zcap;
+	bc_num_setup(&z2, dig_ptr, zcap);
+	dig_ptr += zcap;
+
+	max = bc_num_mulCap(max);
 
 	bc_num_split(a, max2, &l1, &h1);
-	bc_num_split(b, max2, &l2, &h2);
 
 	bc_num_expand(c, max);
 	c->len = max;
@@ -813,998 +1338,2370 @@ static BcStatus bc_num_k(BcNum *a, BcNum *b, BcNum *restrict c) {
 
 	s = bc_num_sub(&h1, &l1, &m1, 0);
 	if (BC_ERR(s)) goto err;
-	s = bc_num_sub(&l2, &h2, &m2, 0);
-	if (BC_ERR(s)) goto err;
 
-	if (BC_NUM_NONZERO(&h1) && BC_NUM_NONZERO(&h2)) {
+	// When squaring, the second operand's pieces are the first operand's, and
+	// m2 is just -m1, so all three products are squares as well.
+	if (sqr) {
+		pl2 = &l1;
+		ph2 = &h1;
+		pm2 = &m1;
+	}
+	else {
+
+		pl2 = &l2;
+		ph2 = &h2;
+		pm2 = &m2;
 
-		s = bc_num_m(&h1, &h2, &z2, 0);
+		bc_num_split(b, max2, &l2, &h2);
+		s = bc_num_sub(&l2, &h2, &m2, 0);
 		if (BC_ERR(s)) goto err;
-		bc_num_clean(&z2);
+	}
+
+	// The three products are all done before any of them are added in, so that
+	// bc_num_mulMany() can run them at the same time. A product that is zero
+	// is skipped, and its BcNum stays zero.
+	len = 0;
+
+	if (BC_NUM_NONZERO(&h1) && BC_NUM_NONZERO(ph2)) {
+		prods[len].a = &h1;
+		prods[len].b = ph2;
+		prods[len++].c = &z2;
+	}
+
+	if (BC_NUM_NONZERO(&l1) && BC_NUM_NONZERO(pl2)) {
+		prods[len].a = &l1;
+		prods[len].b = pl2;
+		prods[len++].c = &z0;
+	}
 
+	if (BC_NUM_NONZERO(&m1) && BC_NUM_NONZERO(pm2)) {
+		prods[len].a = &m1;
+		prods[len].b = pm2;
+		prods[len++].c = &z1;
+	}
+
+	s = bc_num_mulMany(prods, len, BC_MAX(a->len, b->len), dig_ptr);
+	if (BC_ERR(s)) goto err;
+
+	if (BC_NUM_NONZERO(&z2)) {
 		s = bc_num_shiftAddSub(c, &z2, max2 * 2, bc_num_addArrays);
 		if (BC_ERR(s)) goto err;
 		s = bc_num_shiftAddSub(c, &z2, max2, bc_num_addArrays);
 		if (BC_ERR(s)) goto err;
 	}
 
-	if (BC_NUM_NONZERO(&l1) && BC_NUM_NONZERO(&l2)) {
-
-		s = bc_num_m(&l1, &l2, &z0, 0);
-		if (BC_ERR(s)) goto err;
-		bc_num_clean(&z0);
-
+	if (BC_NUM_NONZERO(&z0)) {
 		s = bc_num_shiftAddSub(c, &z0, max2, bc_num_addArrays);
 		if (BC_ERR(s)) goto err;
 		s = bc_num_shiftAddSub(c, &z0, 0, bc_num_addArrays);
 		if (BC_ERR(s)) goto err;
 	}
 
-	if (BC_NUM_NONZERO(&m1) && BC_NUM_NONZERO(&m2)) {
-
-		s = bc_num_m(&m1, &m2, &z1, 0);
-		if (BC_ERR(s)) goto err;
-		bc_num_clean(&z1);
-
-		op = (m1.neg != m2.neg) ? bc_num_subArrays : bc_num_addArrays;
+	if (BC_NUM_NONZERO(&z1)) {
+		op = (sqr || m1.neg != m2.neg) ? bc_num_subArrays : bc_num_addArrays;
 		s = bc_num_shiftAddSub(c, &z1, max2, op);
 		if (BC_ERR(s)) goto err;
 	}
 
 err:
-	free(digs);
-	bc_num_free(&temp);
-	bc_num_free(&z2);
-	bc_num_free(&z1);
-	bc_num_free(&z0);
 	return s;
 }
 
-static BcStatus bc_num_m(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
+static void bc_num_toomPiece(const BcNum *restrict n, size_t idx, size_t len,
+                             BcNum *restrict p)
+{
+	// Pieces are read-only views into n, so they do not own their digits.
+	bc_num_setup(p, n->num, 0);
+
+	if (idx < n->len) {
+		p->num = n->num + idx;
+		p->len = BC_MIN(len, n->len - idx);
+		p->cap = p->len;
+		bc_num_clean(p);
+	}
+}
 
+static BcStatus bc_num_toomAddSub(BcNum *a, BcNum *b, BcNum *c,
+                                  BcNum *restrict temp, bool sub)
+{
 	BcStatus s;
-	BcNum cpa, cpb;
-	size_t ascale, bscale, ardx, brdx, azero = 0, bzero = 0, zero, len, rscale;
 
-	bc_num_zero(c);
-	ascale = a->scale;
-	bscale = b->scale;
-	scale = BC_MAX(scale, ascale);
-	scale = BC_MAX(scale, bscale);
+	// bc_num_add() and bc_num_sub() allocate a new result when it is also an
+	// operand, so this computes it in temp instead and swaps them. Both come
+	// out of the scratch space with the same capacity.
+	if (c != a && c != b) return bc_num_as(a, b, c, sub);
 
-	rscale = ascale + bscale;
-	scale = BC_MIN(rscale, scale);
+	s = bc_num_as(a, b, temp, sub);
 
-	if ((a->len == 1 || b->len == 1) && !a->rdx && !b->rdx) {
+	bc_num_swap(c, temp);
 
-		BcNum *operand;
-		BcBigDig dig;
+	return s;
+}
 
-		if (a->len == 1) {
-			dig = (BcBigDig) a->num[0];
-			operand = b;
-		}
-		else {
-			dig = (BcBigDig) b->num[0];
-			operand = a;
-		}
+static BcStatus bc_num_toomEval(BcNum *n0, BcNum *n1, BcNum *n2,
+                                BcNum *p1, BcNum *pm1, BcNum *pm2, BcNum *temp)
+{
+	BcStatus s;
 
-		s = bc_num_mulArray(operand, dig, c);
-		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	// p(1) = n0 + n1 + n2, p(-1) = n0 - n1 + n2, and
+	// p(-2) = n0 - 2 * n1 + 4 * n2 = 2 * (p(-1) + n2) - n0.
+	s = bc_num_add(n0, n2, temp, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	s = bc_num_add(temp, n1, p1, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	s = bc_num_sub(temp, n1, pm1, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	s = bc_num_add(pm1, n2, temp, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	s = bc_num_add(temp, temp, pm2, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-		if (BC_NUM_NONZERO(c)) c->neg = (a->neg != b->neg);
+	return bc_num_toomAddSub(pm2, n0, pm2, temp, true);
+}
 
-		return s;
+static BcStatus bc_num_toomDivExact(BcNum *restrict n, BcBigDig d,
+                                    BcNum *restrict temp)
+{
+	BcStatus s;
+	BcBigDig rem;
+	bool neg = n->neg;
+
+	bc_num_expand(temp, n->len);
+	bc_num_zero(temp);
+
+	s = bc_num_divArray(n, d, temp, &rem);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+	assert(!rem);
+
+	temp->neg = neg && BC_NUM_NONZERO(temp);
+
+	bc_num_swap(n, temp);
+
+	return s;
+}
+
+static BcStatus bc_num_toom3(BcNum *a, BcNum *b, BcNum *restrict c,
+                             BcDig *restrict scratch)
+{
+	BcStatus s;
+	size_t max, k, i, rcap;
+	BcNum a0, a1, a2, b0, b1, b2, pa1, pam1, pam2, pb1, pbm1, pbm2, eval, temp;
+	BcNum r[5], *rm1, *rm2, *q0, *q1, *qm1, *qm2, *q2;
+	BcNumMulTask prods[5];
+	BcDig *dig_ptr = scratch;
+	bool sqr = (a == b);
+
+	assert(BC_NUM_ZERO(c));
+	assert(!a->rdx && !b->rdx);
+
+	// This is here because the function is recursive.
+	if (BC_SIG) return BC_STATUS_SIGNAL;
+
+	// This is Toom-Cook 3-way multiplication with the evaluation points
+	// 0, 1, -1, -2, and infinity, and the interpolation sequence from Marco
+	// Bodrato. Each operand is split into three pieces of k BcDig's, and the
+	// five pointwise products are computed by bc_num_mulDigs(), so they can
+	// recurse into Toom-Cook again or fall back to Karatsuba. The only
+	// divisions that the interpolation needs are exact divisions by 2 and 3.
+	max = BC_MAX(a->len, b->len);
+	k = (max + 2) / 3;
+
+	bc_num_toomPiece(a, 0, k, &a0);
+	bc_num_toomPiece(a, k, k, &a1);
+	bc_num_toomPiece(a, 2 * k, k, &a2);
+	bc_num_toomPiece(b, 0, k, &b0);
+	bc_num_toomPiece(b, k, k, &b1);
+	bc_num_toomPiece(b, 2 * k, k, &b2);
+
+	// Like in bc_num_k(), everything comes out of the scratch space.
+	max = bc_vm_growSize(k, 2);
+	rcap = bc_num_mulCap(max);
+
+	bc_num_setup(&pa1, dig_ptr, max);
+	dig_ptr += max;
+	bc_num_setup(&pam1, dig_ptr, max);
+	dig_ptr += max;
+	bc_num_setup(&pam2, dig_ptr, max);
+	dig_ptr += max;
+	bc_num_setup(&pb1, dig_ptr, max);
+	dig_ptr += max;
+	bc_num_setup(&pbm1, dig_ptr, max);
+	dig_ptr += max;
+	bc_num_setup(&pbm2, dig_ptr, max);
+	dig_ptr += max;
+	bc_num_setup(&eval, dig_ptr, max);
+	dig_ptr += max;
+
+	bc_num_setup(&temp, dig_ptr, rcap);
+	dig_ptr += rcap;
+
+	for (i = 0; i < 5; ++i) {
+		bc_num_setup(r + i, dig_ptr, rcap);
+		dig_ptr += rcap;
 	}
 
-	bc_num_init(&cpa, a->len + a->rdx);
-	bc_num_init(&cpb, b->len + b->rdx);
-	bc_num_copy(&cpa, a);
-	bc_num_copy(&cpb, b);
+	s = bc_num_toomEval(&a0, &a1, &a2, &pa1, &pam1, &pam2, &eval);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	cpa.neg = cpb.neg = false;
+	// When squaring, b evaluates to the same values as a, so the evaluation is
+	// skipped and the five pointwise products are all squares.
+	if (sqr) {
+		q0 = &a0;
+		q1 = &pa1;
+		qm1 = &pam1;
+		qm2 = &pam2;
+		q2 = &a2;
+	}
+	else {
 
-	ardx = cpa.rdx * BC_BASE_DIGS;
-	s = bc_num_shiftLeft(&cpa, ardx);
+		s = bc_num_toomEval(&b0, &b1, &b2, &pb1, &pbm1, &pbm2, &eval);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+		q0 = &b0;
+		q1 = &pb1;
+		qm1 = &pbm1;
+		qm2 = &pbm2;
+		q2 = &b2;
+	}
+
+	// r[3] and r[2] start out holding p(-2) and p(-1).
+	rm2 = r + 3;
+	rm1 = r + 2;
+
+	prods[0].a = &a0;
+	prods[0].b = q0;
+	prods[0].c = r;
+	prods[1].a = &pa1;
+	prods[1].b = q1;
+	prods[1].c = r + 1;
+	prods[2].a = &pam1;
+	prods[2].b = qm1;
+	prods[2].c = rm1;
+	prods[3].a = &pam2;
+	prods[3].b = qm2;
+	prods[3].c = rm2;
+	prods[4].a = &a2;
+	prods[4].b = q2;
+	prods[4].c = r + 4;
+
+	s = bc_num_mulMany(prods, 5, BC_MAX(a->len, b->len), dig_ptr);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// r3 = (r(-2) - r(1)) / 3
+	s = bc_num_toomAddSub(rm2, r + 1, r + 3, &temp, true);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_toomDivExact(r + 3, 3, &temp);
 	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-	bc_num_clean(&cpa);
-	azero = bc_num_shiftZero(&cpa);
 
-	brdx = cpb.rdx * BC_BASE_DIGS;
-	s = bc_num_shiftLeft(&cpb, brdx);
+	// r1 = (r(1) - r(-1)) / 2
+	s = bc_num_toomAddSub(r + 1, rm1, r + 1, &temp, true);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_toomDivExact(r + 1, 2, &temp);
 	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-	bzero = bc_num_shiftZero(&cpb);
-	bc_num_clean(&cpb);
 
-	s = bc_num_k(&cpa, &cpb, c);
+	// r2 = r(-1) - r(0)
+	s = bc_num_toomAddSub(rm1, r, r + 2, &temp, true);
 	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	zero = bc_vm_growSize(azero, bzero);
-	len = bc_vm_growSize(c->len, zero);
+	// r3 = (r2 - r3) / 2 + 2 * r(inf)
+	s = bc_num_toomAddSub(r + 2, r + 3, r + 3, &temp, true);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_toomDivExact(r + 3, 2, &temp);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_toomAddSub(r + 3, r + 4, r + 3, &temp, false);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_toomAddSub(r + 3, r + 4, r + 3, &temp, false);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	bc_num_expand(c, len);
-	s = bc_num_shiftLeft(c, (len - c->len) * BC_BASE_DIGS);
+	// r2 = r2 + r1 - r(inf)
+	s = bc_num_toomAddSub(r + 2, r + 1, r + 2, &temp, false);
 	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-	s = bc_num_shiftRight(c, ardx + brdx);
+	s = bc_num_toomAddSub(r + 2, r + 4, r + 2, &temp, true);
 	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	bc_num_retireMul(c, scale, a->neg, b->neg);
+	// r1 = r1 - r3
+	s = bc_num_toomAddSub(r + 1, r + 3, r + 1, &temp, true);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	max = bc_vm_growSize(bc_vm_growSize(a->len, b->len), 1);
+	bc_num_expand(c, max);
+	c->len = max;
+	memset(c->num, 0, BC_NUM_SIZE(c->len));
+
+	// All of the coefficients of the product are non-negative, and each one,
+	// shifted into place, is no bigger than the product itself.
+	for (i = 0; BC_NO_SIG && i < 5; ++i) {
+
+		assert(!r[i].neg);
+
+		if (BC_NUM_ZERO(r + i)) continue;
+
+		s = bc_num_shiftAddSub(c, r + i, i * k, bc_num_addArrays);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+
+	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+
+	bc_num_clean(c);
 
 err:
-	bc_num_unshiftZero(&cpb, bzero);
-	bc_num_free(&cpb);
-	bc_num_unshiftZero(&cpa, azero);
-	bc_num_free(&cpa);
 	return s;
 }
 
-static bool bc_num_nonZeroDig(BcDig *restrict a, size_t len) {
-	size_t i;
-	bool nonzero = false;
-	for (i = len - 1; !nonzero && i < len; --i) nonzero = (a[i] != 0);
-	return nonzero;
+static uint32_t bc_num_nttMul(uint32_t a, uint32_t b, uint32_t p) {
+	return (uint32_t) (((uint64_t) a) * b % p);
 }
 
-static ssize_t bc_num_divCmp(const BcDig *a, const BcNum *b, size_t len) {
+static uint32_t bc_num_nttPow(uint32_t b, uint32_t e, uint32_t p) {
 
-	ssize_t cmp;
+	uint32_t r = 1;
 
-	if (b->len > len && a[len]) cmp = bc_num_compare(a, b->num, len + 1);
-	else if (b->len <= len) {
-		if (a[len]) cmp = 1;
-		else cmp = bc_num_compare(a, b->num, len);
+	for (; e; e >>= 1) {
+		if (e & 1) r = bc_num_nttMul(r, b, p);
+		b = bc_num_nttMul(b, b, p);
 	}
-	else cmp = -1;
 
-	return cmp;
+	return r;
 }
 
-static BcStatus bc_num_divExtend(BcNum *restrict a, BcNum *restrict b,
-                                 BcBigDig divisor)
+static void bc_num_nttRoots(uint32_t *restrict roots, size_t n, uint32_t p,
+                            bool inv)
 {
-	BcStatus s;
-	size_t pow;
-
-	pow = BC_BASE_DIGS - bc_num_log10((size_t) divisor);
+	size_t i;
+	uint32_t w = bc_num_nttPow(BC_NUM_NTT_ROOT, (p - 1) / (uint32_t) n, p);
 
-	s = bc_num_shiftLeft(a, pow);
-	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	if (inv) w = bc_num_nttPow(w, p - 2, p);
 
-	return bc_num_shiftLeft(b, pow);
+	for (roots[0] = 1, i = 1; i < n / 2; ++i)
+		roots[i] = bc_num_nttMul(roots[i - 1], w, p);
 }
 
-static BcStatus bc_num_d_long(BcNum *restrict a, BcNum *restrict b,
-                              BcNum *restrict c, size_t scale)
+static BcStatus bc_num_nttTransform(uint32_t *restrict a, size_t n,
+                                    const uint32_t *restrict roots, uint32_t p)
 {
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcBigDig divisor;
-	size_t len, end, i, rdx;
-	BcNum cpb;
-	bool nonzero = false;
-
-	assert(b->len < a->len);
-	len = b->len;
-	end = a->len - len;
-	assert(len >= 1);
-
-	bc_num_expand(c, a->len);
-	memset(c->num, 0, c->cap * sizeof(BcDig));
+	size_t i, j, k, len, half, step;
 
-	c->rdx = a->rdx;
-	c->scale = a->scale;
-	c->len = a->len;
+	for (i = 1, j = 0; i < n; ++i) {
 
-	divisor = (BcBigDig) b->num[len - 1];
+		size_t bit = n >> 1;
 
-	if (len > 1 && bc_num_nonZeroDig(b->num, len - 1)) {
+		for (; j & bit; bit >>= 1) j ^= bit;
+		j ^= bit;
 
-		nonzero = (divisor > 1 << ((10 * BC_BASE_DIGS) / 6 + 1));
+		if (i < j) {
+			uint32_t temp = a[i];
+			a[i] = a[j];
+			a[j] = temp;
+		}
+	}
 
-		if (!nonzero) {
+	for (len = 2; BC_NO_SIG && len <= n; len <<= 1) {
 
-			s = bc_num_divExtend(a, b, divisor);
-			if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+		half = len >> 1;
+		step = n / len;
 
-			len = BC_MAX(a->len, b->len);
-			bc_num_expand(a, len + 1);
+		for (i = 0; i < n; i += len) {
 
-			if (len + 1 > a->len) a->len = len + 1;
+			for (j = i, k = 0; j < i + half; ++j, k += step) {
 
-			len = b->len;
-			end = a->len - len;
-			divisor = (BcBigDig) b->num[len - 1];
+				uint32_t u = a[j], v = bc_num_nttMul(a[j + half], roots[k], p);
 
-			nonzero = bc_num_nonZeroDig(b->num, len - 1);
+				a[j] = u + v >= p ? u + v - p : u + v;
+				a[j + half] = u >= v ? u - v : u + p - v;
+			}
 		}
 	}
 
-	divisor += nonzero;
+	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+}
 
-	bc_num_expand(c, a->len);
-	memset(c->num, 0, BC_NUM_SIZE(c->cap));
+static void bc_num_nttLoad(uint32_t *restrict w, size_t n,
+                           const BcNum *restrict a, uint32_t p)
+{
+	size_t i, j, len = (a->len + BC_NUM_NTT_PACK - 1) / BC_NUM_NTT_PACK;
 
-	assert(c->scale >= scale);
-	rdx = c->rdx - BC_NUM_RDX(scale);
+	for (i = 0; i < len; ++i) {
 
-	bc_num_init(&cpb, len + 1);
+		uint64_t word = 0;
 
-	i = end - 1;
+		for (j = BC_NUM_NTT_PACK - 1; j < BC_NUM_NTT_PACK; --j) {
+			size_t idx = i * BC_NUM_NTT_PACK + j;
+			word *= BC_BASE_POW;
+			if (idx < a->len) word += (uint64_t) a->num[idx];
+		}
 
-	for (; BC_NO_SIG && i < end && i >= rdx && BC_NUM_NONZERO(a); --i) {
+		w[i] = (uint32_t) (word % p);
+	}
 
-		ssize_t cmp;
-		BcDig *n;
-		BcBigDig q, result;
+	memset(w + len, 0, (n - len) * sizeof(uint32_t));
+}
 
-		n = a->num + i;
-		assert(n >= a->num);
-		result = q = 0;
+static size_t bc_num_nttLen(const BcNum *a, const BcNum *b) {
 
-		cmp = bc_num_divCmp(n, b, len);
+	size_t n = 1, len;
 
-#if BC_ENABLE_SIGNALS
-		if (BC_NUM_CMP_SIGNAL(cmp)) goto err;
-#endif // BC_ENABLE_SIGNALS
+	len = (a->len + BC_NUM_NTT_PACK - 1) / BC_NUM_NTT_PACK;
+	len += (b->len + BC_NUM_NTT_PACK - 1) / BC_NUM_NTT_PACK;
 
-		while (cmp >= 0) {
+	while (n < len) n <<= 1;
 
-			BcBigDig n1, dividend;
+	return n;
+}
 
-			n1 = (BcBigDig) n[len];
-			dividend = n1 * BC_BASE_POW + (BcBigDig) n[len - 1];
-			q = (dividend / divisor);
+static bool bc_num_nttOk(const BcNum *a, const BcNum *b) {
+	return a->len >= BC_NUM_NTT_LEN && b->len >= BC_NUM_NTT_LEN &&
+	       bc_num_nttLen(a, b) <= BC_NUM_NTT_MAX;
+}
 
-			if (q <= 1) {
-				q = 1;
-				s = bc_num_subArrays(n, b->num, len);
-				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-			}
-			else {
+static BcStatus bc_num_nttPrime(void *data) {
 
-				assert(q <= BC_BASE_POW);
+	BcStatus s;
+	BcNumNttTask *t = (BcNumNttTask*) data;
+	uint32_t *res = t->res, *fb = t->fb, *roots = t->roots, p = t->p, ninv;
+	size_t j, n = t->n;
 
-				s = bc_num_mulArray(b, (BcBigDig) q, &cpb);
-				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_nttLoad(res, n, t->a, p);
+	bc_num_nttRoots(roots, n, p, false);
 
-				s = bc_num_subArrays(n, cpb.num, cpb.len);
-				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-			}
+	s = bc_num_nttTransform(res, n, roots, p);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-			result += q;
-			assert(result <= BC_BASE_POW);
+	if (t->a == t->b) {
+		for (j = 0; j < n; ++j) res[j] = bc_num_nttMul(res[j], res[j], p);
+	}
+	else {
 
-			if (nonzero) {
-				cmp = bc_num_divCmp(n, b, len);
-#if BC_ENABLE_SIGNALS
-				if (BC_NUM_CMP_SIGNAL(cmp)) goto err;
-#endif // BC_ENABLE_SIGNALS
-			}
-			else cmp = -1;
-		}
+		bc_num_nttLoad(fb, n, t->b, p);
 
-		assert(result < BC_BASE_POW);
+		s = bc_num_nttTransform(fb, n, roots, p);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-		c->num[i] = (BcDig) result;
+		for (j = 0; j < n; ++j) res[j] = bc_num_nttMul(res[j], fb[j], p);
 	}
 
-err:
-	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
-	bc_num_free(&cpb);
+	bc_num_nttRoots(roots, n, p, true);
+
+	s = bc_num_nttTransform(res, n, roots, p);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+	ninv = bc_num_nttPow((uint32_t) (n % p), p - 2, p);
+
+	for (j = 0; j < n; ++j) res[j] = bc_num_nttMul(res[j], ninv, p);
+
 	return s;
 }
 
-static BcStatus bc_num_d(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
+static BcStatus bc_num_ntt(BcNum *a, BcNum *b, BcNum *restrict c) {
 
 	BcStatus s = BC_STATUS_SUCCESS;
-	size_t len;
-	BcNum cpa, cpb;
+	BcNumNttTask primes[BC_NUM_NTT_PRIMES];
+	uint32_t *digs, *res[BC_NUM_NTT_PRIMES];
+	uint32_t p1, p2, p3, inv12, inv13, inv23;
+	uint64_t carry = 0;
+	size_t i, j, k, n, clen, bufs;
+	bool threaded;
 
-	if (BC_NUM_ZERO(b)) return bc_vm_err(BC_ERROR_MATH_DIVIDE_BY_ZERO);
-	if (BC_NUM_ZERO(a)) {
-		bc_num_setToZero(c, scale);
-		return BC_STATUS_SUCCESS;
-	}
-	if (BC_NUM_ONE(b)) {
-		bc_num_copy(c, a);
-		bc_num_retireMul(c, scale, a->neg, b->neg);
-		return BC_STATUS_SUCCESS;
-	}
-	if (!a->rdx && !b->rdx && b->len == 1 && !scale) {
-		BcBigDig rem;
-		s = bc_num_divArray(a, (BcBigDig) b->num[0], c, &rem);
-		bc_num_retireMul(c, scale, a->neg, b->neg);
-		return s;
+	assert(BC_NUM_ZERO(c));
+	assert(!a->rdx && !b->rdx);
+
+	// This is a number-theoretic transform multiplication. It takes the
+	// convolution of the operands modulo three primes that have big powers of
+	// two as factors of p - 1, then uses the Chinese Remainder Theorem to put
+	// each coefficient back together. The primes are chosen so that their
+	// product is bigger than any possible coefficient, which means that the
+	// result is exact.
+	//
+	// When BcDig's are too small, several of them are packed into one word
+	// of BC_NUM_NTT_BASE, which keeps the transform short. When squaring, only
+	// one forward transform per prime is needed. The primes do not depend on
+	// each other until the end, so they can be done on separate threads.
+	n = bc_num_nttLen(a, b);
+	assert(n <= BC_NUM_NTT_MAX);
+
+	threaded = bc_num_threaded(BC_MAX(a->len, b->len));
+	bufs = threaded ? BC_NUM_NTT_PRIMES : 1;
+
+	digs = bc_vm_malloc(bc_vm_arraySize(BC_NUM_NTT_PRIMES + 2 * bufs, n) *
+	                    sizeof(uint32_t));
+
+	for (i = 0; i < BC_NUM_NTT_PRIMES; ++i) {
+
+		// Each prime needs its own space for b and the roots when the primes
+		// are done at the same time. Otherwise, they all share the same space.
+		j = threaded ? i : 0;
+
+		primes[i].a = a;
+		primes[i].b = b;
+		primes[i].res = digs + i * n;
+		primes[i].fb = digs + (BC_NUM_NTT_PRIMES + 2 * j) * n;
+		primes[i].roots = primes[i].fb + n;
+		primes[i].n = n;
+		primes[i].p = bc_num_ntt_primes[i];
+
+		res[i] = primes[i].res;
 	}
 
-	len = bc_num_mulReq(a, b, scale);
-	bc_num_init(&cpa, len);
-	bc_num_copy(&cpa, a);
-	bc_num_createCopy(&cpb, b);
+	s = bc_num_tasks(bc_num_nttPrime, primes, sizeof(BcNumNttTask),
+	                 BC_NUM_NTT_PRIMES, threaded);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	len = b->len;
+	p1 = bc_num_ntt_primes[0];
+	p2 = bc_num_ntt_primes[1];
+	p3 = bc_num_ntt_primes[2];
 
-	if (len > cpa.len) {
-		bc_num_expand(&cpa, bc_vm_growSize(len, 2));
-		bc_num_extend(&cpa, (len - cpa.len) * BC_BASE_DIGS);
-	}
+	inv12 = bc_num_nttPow(p1 % p2, p2 - 2, p2);
+	inv13 = bc_num_nttPow(p1 % p3, p3 - 2, p3);
+	inv23 = bc_num_nttPow(p2 % p3, p3 - 2, p3);
 
-	cpa.scale = cpa.rdx * BC_BASE_DIGS;
+	clen = bc_vm_growSize(bc_vm_growSize(a->len, b->len), BC_NUM_NTT_PACK);
+	bc_num_expand(c, clen);
+	memset(c->num, 0, BC_NUM_SIZE(clen));
 
-	bc_num_extend(&cpa, b->scale);
-	cpa.rdx -= BC_NUM_RDX(b->scale);
-	cpa.scale = cpa.rdx * BC_BASE_DIGS;
+	// Garner's algorithm turns the residues into x = t1 + p1 * y, where
+	// y = t2 + p2 * t3 is less than p2 * p3, so it fits in 64 bits. Then x is
+	// added into the result in BC_NUM_NTT_BASE without ever computing it.
+	for (i = 0, k = 0; BC_NO_SIG && i < n && k < clen; ++i) {
 
-	if (scale > cpa.scale) {
-		bc_num_extend(&cpa, scale);
-		cpa.scale = cpa.rdx * BC_BASE_DIGS;
-	}
-
-	if (cpa.cap == cpa.len) bc_num_expand(&cpa, bc_vm_growSize(cpa.len, 1));
+		uint64_t t1, t2, t3, y, lo;
 
-	// We want an extra zero in front to make things simpler.
-	cpa.num[cpa.len++] = 0;
+		t1 = res[0][i];
+		t2 = bc_num_nttMul((res[1][i] + p2 - (uint32_t) (t1 % p2)) % p2,
+		                   inv12, p2);
+		t3 = bc_num_nttMul((res[2][i] + p3 - (uint32_t) (t1 % p3)) % p3,
+		                   inv13, p3);
+		t3 = bc_num_nttMul((uint32_t) ((t3 + p3 - t2 % p3) % p3), inv23, p3);
 
-	if (cpa.rdx == cpa.len) cpa.len = bc_num_nonzeroLen(&cpa);
-	if (cpb.rdx == cpb.len) cpb.len = bc_num_nonzeroLen(&cpb);
-	cpb.scale = cpb.rdx = 0;
+		y = t2 + ((uint64_t) p2) * t3;
 
-	s = bc_num_d_long(&cpa, &cpb, c, scale);
+		lo = t1 + p1 * (y % BC_NUM_NTT_BASE) + carry;
+		carry = lo / BC_NUM_NTT_BASE + p1 * (y / BC_NUM_NTT_BASE);
+		lo %= BC_NUM_NTT_BASE;
 
-	if (BC_NO_ERR(!s)) {
-		if (BC_SIG) s = BC_STATUS_SIGNAL;
-		else bc_num_retireMul(c, scale, a->neg, b->neg);
+		for (j = 0; j < BC_NUM_NTT_PACK && k < clen; ++j, ++k) {
+			c->num[k] = (BcDig) (lo % BC_BASE_POW);
+			lo /= BC_BASE_POW;
+		}
 	}
 
-	bc_num_free(&cpb);
-	bc_num_free(&cpa);
+	assert(!carry || BC_SIG);
 
+	c->len = clen;
+	bc_num_clean(c);
+
+	if (BC_SIG) s = BC_STATUS_SIGNAL;
+
+err:
+	free(digs);
 	return s;
 }
 
-static BcStatus bc_num_r(BcNum *a, BcNum *b, BcNum *restrict c,
-                         BcNum *restrict d, size_t scale, size_t ts)
+static BcStatus bc_num_mulDigs(BcNum *a, BcNum *b, BcNum *restrict c,
+                               BcDig *restrict scratch)
 {
 	BcStatus s;
-	BcNum temp;
-	bool neg;
-
-	if (BC_NUM_ZERO(b)) return bc_vm_err(BC_ERROR_MATH_DIVIDE_BY_ZERO);
-	if (BC_NUM_ZERO(a)) {
-		bc_num_setToZero(c, ts);
-		bc_num_setToZero(d, ts);
-		return BC_STATUS_SUCCESS;
-	}
 
-	bc_num_init(&temp, d->cap);
-	s = bc_num_d(a, b, c, scale);
-	assert(!s || s == BC_STATUS_SIGNAL);
-	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	assert(!a->rdx && !b->rdx);
 
-	if (scale) scale = ts + 1;
+	bc_num_zero(c);
 
-	s = bc_num_m(c, b, &temp, scale);
-	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-	s = bc_num_sub(a, &temp, d, scale);
-	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	// The kernels ignore the signs of the operands and may leave zeroes at the
+	// top of the result, so the result is fixed up here.
+	if (bc_num_nttOk(a, b)) s = bc_num_ntt(a, b, c);
+	else if (a->len >= BC_NUM_TOOM_LEN && b->len >= BC_NUM_TOOM_LEN)
+		s = bc_num_toom3(a, b, c, scratch);
+	else s = bc_num_k(a, b, c, scratch);
 
-	if (ts > d->scale && BC_NUM_NONZERO(d)) bc_num_extend(d, ts - d->scale);
+	bc_num_clean(c);
 
-	neg = d->neg;
-	bc_num_retireMul(d, ts, a->neg, b->neg);
-	d->neg = BC_NUM_NONZERO(d) ? neg : false;
+	if (BC_NUM_NONZERO(c)) c->neg = (a->neg != b->neg);
 
-err:
-	bc_num_free(&temp);
 	return s;
 }
 
-static BcStatus bc_num_rem(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale)
+// Multiplies the integers a and b when the lowest places digits of the product
+// are going to be truncated, by skipping the columns of the schoolbook product
+// that are far enough below them. There are at most n products in a column,
+// where n is the length of the shorter operand, so if BC_BASE_POW^h >= n, the
+// columns below skip add up to less than BC_BASE_POW^(skip + 1 + h). skip is
+// chosen so that is one limb below the cut, and the digits that are kept can
+// only be different from the whole product if there could be a carry into
+// them, which means that the limb below the cut, and the digits of the limb at
+// the cut that are below it, are all nines. Then the whole product is computed
+// instead, so the result is always the same. Sets *done to false if a short
+// product would not be faster, which is when the full product would use
+// Karatsuba, Toom-3, or the NTT and one operand has BC_NUM_SHORT_LEN limbs.
+static BcStatus bc_num_mulShort(const BcNum *a, const BcNum *b,
+                                BcNum *restrict c, size_t places, bool *done)
 {
 	BcStatus s;
-	BcNum c1;
-	size_t ts;
+	size_t skip, h, t, lim = places / BC_BASE_DIGS;
+	size_t min = BC_MIN(a->len, b->len), max = BC_MAX(a->len, b->len);
+	BcBigDig pow = bc_num_pow10[places % BC_BASE_DIGS];
+	BcDig dig;
 
-	ts = bc_vm_growSize(scale, b->scale);
-	ts = BC_MAX(ts, a->scale);
+	*done = false;
 
-	bc_num_init(&c1, bc_num_mulReq(a, b, ts));
-	s = bc_num_r(a, b, &c1, c, scale, ts);
-	bc_num_free(&c1);
+	if (min >= BC_NUM_KARATSUBA_LEN && max >= BC_NUM_SHORT_LEN)
+		return BC_STATUS_SUCCESS;
+
+	for (h = 0, t = min - 1; t; ++h) t /= BC_BASE_POW;
+
+	if (lim <= h + 2) return BC_STATUS_SUCCESS;
+
+	skip = lim - h - 2;
+
+	s = a == b ? bc_num_sqr_simp(a, c, skip) : bc_num_m_simp(a, b, c, skip);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+	dig = lim < c->len ? c->num[lim] : 0;
+
+	*done = (lim - 1 >= c->len || c->num[lim - 1] != BC_BASE_POW - 1 ||
+	         ((BcBigDig) dig) % pow != pow - 1);
+
+	if (*done) bc_num_clean(c);
+	else bc_num_zero(c);
 
 	return s;
 }
 
-static BcStatus bc_num_p(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
+static BcStatus bc_num_m(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
 
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcNum copy;
-	BcBigDig pow = 0;
-	size_t i, powrdx, resrdx;
-	bool neg, zero;
+	BcStatus s;
+	BcNum cpa, cpb, *ptrb;
+	BcDig *scratch = NULL;
+	size_t ascale, bscale, ardx, brdx, azero = 0, bzero = 0, zero, len, rscale;
+	size_t places;
+	bool sqr = (a == b), done = false;
 
-	if (BC_ERR(b->rdx)) return bc_vm_err(BC_ERROR_MATH_NON_INTEGER);
+	bc_num_zero(c);
+	ascale = a->scale;
+	bscale = b->scale;
+	scale = BC_MAX(scale, ascale);
+	scale = BC_MAX(scale, bscale);
+
+	rscale = ascale + bscale;
+	scale = BC_MIN(rscale, scale);
+
+	if ((a->len == 1 || b->len == 1) && !a->rdx && !b->rdx) {
+
+		BcNum *operand;
+		BcBigDig dig;
+
+		if (a->len == 1) {
+			dig = (BcBigDig) a->num[0];
+			operand = b;
+		}
+		else {
+			dig = (BcBigDig) b->num[0];
+			operand = a;
+		}
+
+		s = bc_num_mulArray(operand, dig, c);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+		if (BC_NUM_NONZERO(c)) c->neg = (a->neg != b->neg);
 
-	if (BC_NUM_ZERO(b)) {
-		bc_num_one(c);
-		return BC_STATUS_SUCCESS;
-	}
-	if (BC_NUM_ZERO(a)) {
-		if (b->neg) return bc_vm_err(BC_ERROR_MATH_DIVIDE_BY_ZERO);
-		bc_num_setToZero(c, scale);
-		return BC_STATUS_SUCCESS;
-	}
-	if (BC_NUM_ONE(b)) {
-		if (!b->neg) bc_num_copy(c, a);
-		else s = bc_num_inv(a, c, scale);
 		return s;
 	}
 
-	neg = b->neg;
-	b->neg = false;
-	s = bc_num_bigdig(b, &pow);
-	b->neg = neg;
-	if (s) return s;
-
-	bc_num_createCopy(&copy, a);
+	// When squaring, there is only one copy, and the kernels get the same
+	// pointer twice, which is how they know to use their squaring paths.
+	bc_num_init(&cpa, a->len + a->rdx);
+	bc_num_copy(&cpa, a);
+	cpa.neg = false;
 
-	if (!neg) {
-		size_t max = BC_MAX(scale, a->scale), scalepow = a->scale * pow;
-		scale = BC_MIN(scalepow, max);
+	if (!sqr) {
+		bc_num_init(&cpb, b->len + b->rdx);
+		bc_num_copy(&cpb, b);
+		cpb.neg = false;
+		ptrb = &cpb;
 	}
+	else ptrb = &cpa;
 
-	for (powrdx = a->scale; BC_NO_SIG && !(pow & 1); pow >>= 1) {
-		powrdx <<= 1;
-		s = bc_num_mul(&copy, &copy, &copy, powrdx);
+	ardx = cpa.rdx * BC_BASE_DIGS;
+	s = bc_num_shiftLeft(&cpa, ardx);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_clean(&cpa);
+	azero = bc_num_shiftZero(&cpa);
+
+	if (!sqr) {
+		brdx = cpb.rdx * BC_BASE_DIGS;
+		s = bc_num_shiftLeft(&cpb, brdx);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		bzero = bc_num_shiftZero(&cpb);
+		bc_num_clean(&cpb);
+	}
+	else {
+		brdx = ardx;
+		bzero = azero;
 	}
 
-	if (BC_SIG) goto sig_err;
-
-	bc_num_copy(c, &copy);
-	resrdx = powrdx;
+	zero = bc_vm_growSize(azero, bzero);
 
-	while (BC_NO_SIG && (pow >>= 1)) {
+	// The digits of the product that are truncated by bc_num_retireMul(), not
+	// counting the zero limbs that were shifted off of the operands.
+	places = ardx + brdx - scale;
 
-		powrdx <<= 1;
-		s = bc_num_mul(&copy, &copy, &copy, powrdx);
+	if (places > zero * BC_BASE_DIGS) {
+		places -= zero * BC_BASE_DIGS;
+		s = bc_num_mulShort(&cpa, ptrb, c, places, &done);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
 
-		if (pow & 1) {
-			resrdx += powrdx;
-			s = bc_num_mul(c, &copy, c, resrdx);
-			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	if (!done) {
+
+		// The scratch space for the whole recursion is allocated once, here.
+		if (cpa.len >= BC_NUM_KARATSUBA_LEN &&
+		    ptrb->len >= BC_NUM_KARATSUBA_LEN && !bc_num_nttOk(&cpa, ptrb))
+		{
+			len = bc_num_mulScratch(BC_MAX(cpa.len, ptrb->len));
+			scratch = bc_vm_malloc(BC_NUM_SIZE(len));
 		}
-	}
 
-	if (BC_SIG) goto sig_err;
-	if (neg) {
-		s = bc_num_inv(c, c, scale);
+		s = bc_num_mulDigs(&cpa, ptrb, c, scratch);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 	}
 
-	if (c->scale > scale) bc_num_truncate(c, c->scale - scale);
+	len = bc_vm_growSize(c->len, zero);
 
-	// We can't use bc_num_clean() here.
-	for (zero = true, i = 0; zero && i < c->len; ++i) zero = !c->num[i];
-	if (zero) bc_num_setToZero(c, scale);
+	bc_num_expand(c, len);
+	s = bc_num_shiftLeft(c, (len - c->len) * BC_BASE_DIGS);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_shiftRight(c, ardx + brdx);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	bc_num_retireMul(c, scale, a->neg, b->neg);
 
-sig_err:
-	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
 err:
-	bc_num_free(&copy);
+	free(scratch);
+	if (!sqr) {
+		bc_num_unshiftZero(&cpb, bzero);
+		bc_num_free(&cpb);
+	}
+	bc_num_unshiftZero(&cpa, azero);
+	bc_num_free(&cpa);
 	return s;
 }
 
-#if BC_ENABLE_EXTRA_MATH
-static BcStatus bc_num_place(BcNum *a, BcNum *b, BcNum *restrict c,
-                             size_t scale)
-{
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcBigDig val = 0;
+static bool bc_num_nonZeroDig(BcDig *restrict a, size_t len) {
+	size_t i;
+	bool nonzero = false;
+	for (i = len - 1; !nonzero && i < len; --i) nonzero = (a[i] != 0);
+	return nonzero;
+}
 
-	BC_UNUSED(scale);
+static ssize_t bc_num_divCmp(const BcDig *a, const BcNum *b, size_t len) {
 
-	s = bc_num_intop(a, b, c, &val);
-	if (BC_ERR(s)) return s;
+	ssize_t cmp;
 
-	if (val < c->scale) bc_num_truncate(c, c->scale - val);
-	else if (val > c->scale) bc_num_extend(c, val - c->scale);
+	if (b->len > len && a[len]) cmp = bc_num_compare(a, b->num, len + 1);
+	else if (b->len <= len) {
+		if (a[len]) cmp = 1;
+		else cmp = bc_num_compare(a, b->num, len);
+	}
+	else cmp = -1;
 
-	return s;
+	return cmp;
 }
 
-static BcStatus bc_num_left(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale)
+static BcStatus bc_num_divExtend(BcNum *restrict a, BcNum *restrict b,
+                                 BcBigDig divisor)
 {
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcBigDig val = 0;
+	BcStatus s;
+	size_t pow;
 
-	BC_UNUSED(scale);
+	pow = BC_BASE_DIGS - bc_num_log10((size_t) divisor);
 
-	s = bc_num_intop(a, b, c, &val);
-	if (BC_ERR(s)) return s;
+	s = bc_num_shiftLeft(a, pow);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-	return bc_num_shiftLeft(c, (size_t) val);
+	return bc_num_shiftLeft(b, pow);
 }
 
-static BcStatus bc_num_right(BcNum *a, BcNum *b, BcNum *restrict c,
-                             size_t scale)
+static BcStatus bc_num_d_long(BcNum *restrict a, BcNum *restrict b,
+                              BcNum *restrict c, size_t scale)
 {
 	BcStatus s = BC_STATUS_SUCCESS;
-	BcBigDig val = 0;
+	BcBigDig divisor;
+	size_t len, end, i, rdx;
+	BcNum cpb;
+	bool nonzero = false;
 
-	BC_UNUSED(scale);
+	assert(b->len < a->len);
+	len = b->len;
+	end = a->len - len;
+	assert(len >= 1);
 
-	s = bc_num_intop(a, b, c, &val);
-	if (BC_ERR(s)) return s;
+	bc_num_expand(c, a->len);
+	memset(c->num, 0, c->cap * sizeof(BcDig));
 
-	if (BC_NUM_ZERO(c)) return s;
+	c->rdx = a->rdx;
+	c->scale = a->scale;
+	c->len = a->len;
 
-	return bc_num_shiftRight(c, (size_t) val);
-}
-#endif // BC_ENABLE_EXTRA_MATH
+	divisor = (BcBigDig) b->num[len - 1];
 
-static BcStatus bc_num_binary(BcNum *a, BcNum *b, BcNum *c, size_t scale,
-                              BcNumBinaryOp op, size_t req)
-{
-	BcStatus s;
-	BcNum num2, *ptr_a, *ptr_b;
-	bool init = false;
+	if (len > 1 && bc_num_nonZeroDig(b->num, len - 1)) {
 
-	assert(a != NULL && b != NULL && c != NULL && op != NULL);
+		nonzero = (divisor > 1 << ((10 * BC_BASE_DIGS) / 6 + 1));
 
-	if (c == a) {
-		ptr_a = &num2;
-		memcpy(ptr_a, c, sizeof(BcNum));
-		init = true;
-	}
-	else ptr_a = a;
+		if (!nonzero) {
 
-	if (c == b) {
-		ptr_b = &num2;
-		if (c != a) {
-			memcpy(ptr_b, c, sizeof(BcNum));
-			init = true;
-		}
-	}
-	else ptr_b = b;
+			s = bc_num_divExtend(a, b, divisor);
+			if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-	if (init) bc_num_init(c, req);
-	else bc_num_expand(c, req);
+			len = BC_MAX(a->len, b->len);
+			bc_num_expand(a, len + 1);
 
-	s = op(ptr_a, ptr_b, c, scale);
+			if (len + 1 > a->len) a->len = len + 1;
 
-	assert(!c->neg || BC_NUM_NONZERO(c));
-	assert(c->rdx <= c->len || !c->len || s);
-	assert(!c->len || c->num[c->len - 1] || c->rdx == c->len);
+			len = b->len;
+			end = a->len - len;
+			divisor = (BcBigDig) b->num[len - 1];
 
-	if (init) bc_num_free(&num2);
+			nonzero = bc_num_nonZeroDig(b->num, len - 1);
+		}
+	}
 
-	return s;
-}
+	divisor += nonzero;
 
-#ifndef NDEBUG
-static bool bc_num_strValid(const char *val) {
+	bc_num_expand(c, a->len);
+	memset(c->num, 0, BC_NUM_SIZE(c->cap));
 
-	bool radix = false;
-	size_t i, len = strlen(val);
+	assert(c->scale >= scale);
+	rdx = c->rdx - BC_NUM_RDX(scale);
 
-	if (!len) return true;
+	bc_num_init(&cpb, len + 1);
 
-	for (i = 0; i < len; ++i) {
+	i = end - 1;
 
-		BcDig c = val[i];
+	for (; BC_NO_SIG && i < end && i >= rdx && BC_NUM_NONZERO(a); --i) {
 
-		if (c == '.') {
+		ssize_t cmp;
+		BcDig *n;
+		BcBigDig q, result;
 
-			if (radix) return false;
+		n = a->num + i;
+		assert(n >= a->num);
+		result = q = 0;
 
-			radix = true;
-			continue;
-		}
+		cmp = bc_num_divCmp(n, b, len);
 
-		if (!(isdigit(c) || isupper(c))) return false;
-	}
+#if BC_ENABLE_SIGNALS
+		if (BC_NUM_CMP_SIGNAL(cmp)) goto err;
+#endif // BC_ENABLE_SIGNALS
 
-	return true;
-}
-#endif // NDEBUG
+		while (cmp >= 0) {
 
-static BcBigDig bc_num_parseChar(char c, size_t base_t) {
+			BcBigDig n1, dividend;
 
-	if (isupper(c)) {
-		c = BC_NUM_NUM_LETTER(c);
-		c = ((size_t) c) >= base_t ? (char) base_t - 1 : c;
-	}
-	else c -= '0';
+			n1 = (BcBigDig) n[len];
+			dividend = n1 * BC_BASE_POW + (BcBigDig) n[len - 1];
+			q = (dividend / divisor);
 
-	return (BcBigDig) (uchar) c;
-}
+			if (q <= 1) {
+				q = 1;
+				s = bc_num_subArrays(n, b->num, len);
+				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+			}
+			else {
 
-static void bc_num_parseDecimal(BcNum *restrict n, const char *restrict val) {
+				assert(q <= BC_BASE_POW);
 
-	size_t len, i, temp, mod;
-	const char *ptr;
-	bool zero = true, rdx;
+				s = bc_num_mulArray(b, (BcBigDig) q, &cpb);
+				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	for (i = 0; val[i] == '0'; ++i);
+				s = bc_num_subArrays(n, cpb.num, cpb.len);
+				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+			}
 
-	val += i;
-	assert(!val[0] || isalnum(val[0]) || val[0] == '.');
+			result += q;
+			assert(result <= BC_BASE_POW);
 
-	// All 0's. We can just return, since this
-	// procedure expects a virgin (already 0) BcNum.
-	if (!val[0]) return;
+			if (nonzero) {
+				cmp = bc_num_divCmp(n, b, len);
+#if BC_ENABLE_SIGNALS
+				if (BC_NUM_CMP_SIGNAL(cmp)) goto err;
+#endif // BC_ENABLE_SIGNALS
+			}
+			else cmp = -1;
+		}
 
-	len = strlen(val);
+		assert(result < BC_BASE_POW);
 
-	ptr = strchr(val, '.');
-	rdx = (ptr != NULL);
+		c->num[i] = (BcDig) result;
+	}
 
-	for (i = 0; i < len && (zero = (val[i] == '0' || val[i] == '.')); ++i);
+err:
+	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+	bc_num_free(&cpb);
+	return s;
+}
 
-	n->scale = (size_t) (rdx * ((val + len) - (ptr + 1)));
-	n->rdx = BC_NUM_RDX(n->scale);
+static void bc_num_newtonPow(BcNum *restrict n, size_t places) {
+	bc_num_init(n, bc_vm_growSize(places, 1));
+	memset(n->num, 0, BC_NUM_SIZE(places));
+	n->num[places] = 1;
+	n->len = places + 1;
+}
 
-	i = len - (ptr == val ? 0 : i) - rdx;
-	temp = BC_NUM_ROUND_POW(i);
-	mod = n->scale % BC_BASE_DIGS;
-	i = mod ? BC_BASE_DIGS - mod : 0;
-	n->len = ((temp + i) / BC_BASE_DIGS);
+static void bc_num_divHigh(const BcNum *restrict n, size_t places,
+                           BcNum *restrict p)
+{
+	// This is a read-only view of n without its low places BcDig's, which is
+	// the same as dividing by a power of BC_BASE_POW and truncating.
+	bc_num_toomPiece(n, places, n->len, p);
+	if (BC_NUM_NONZERO(p)) p->neg = n->neg;
+}
 
-	bc_num_expand(n, n->len);
-	memset(n->num, 0, BC_NUM_SIZE(n->len));
+static BcStatus bc_num_newtonInv(BcNum *restrict d, size_t p,
+                                 BcNum *restrict x)
+{
+	BcStatus s;
+	BcNum dh, pow, t, e, high;
+	size_t h;
 
-	if (zero) n->len = n->rdx = 0;
-	else {
+	assert(d->len == p && !d->rdx && !d->neg);
 
-		BcBigDig exp, pow;
+	// This computes x = BC_BASE_POW^(2p) / d for a d of p BcDig's, give or
+	// take a few units. Small reciprocals are done with long division.
+	bc_num_newtonPow(&pow, bc_vm_growSize(p, p));
 
-		assert(i <= BC_NUM_BIGDIG_MAX);
+	if (p < BC_NUM_NEWTON_LEN) {
+		s = bc_num_d(&pow, d, x, 0);
+		bc_num_free(&pow);
+		return s;
+	}
 
-		exp = (BcBigDig) i;
-		pow = bc_num_pow10[exp];
+	// Otherwise, the reciprocal of the top half of d (plus a couple of guard
+	// BcDig's) is computed recursively and refined with one Newton step,
+	// x = x + x * (BC_BASE_POW^(2p) - d * x) / BC_BASE_POW^(2p), which doubles
+	// the number of correct BcDig's.
+	h = p / 2 + 2;
+	assert(h < p);
 
-		for (i = len - 1; i < len; --i, ++exp) {
+	bc_num_toomPiece(d, p - h, h, &dh);
 
-			char c = val[i];
+	bc_num_init(&t, bc_vm_growSize(p, p));
+	bc_num_init(&e, bc_vm_growSize(p, p));
 
-			if (c == '.') exp -= 1;
-			else {
+	s = bc_num_newtonInv(&dh, h, x);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_shiftLeft(x, (p - h) * BC_BASE_DIGS);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-				size_t idx = exp / BC_BASE_DIGS;
+	s = bc_num_mul(d, x, &t, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_sub(&pow, &t, &e, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mul(x, &e, &t, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-				if (isupper(c)) c = '9';
-				n->num[idx] += (((BcBigDig) c) - '0') * pow;
+	bc_num_divHigh(&t, pow.len - 1, &high);
 
-				if ((exp + 1) % BC_BASE_DIGS == 0) pow = 1;
-				else pow *= BC_BASE;
-			}
-		}
-	}
+	s = bc_num_add(x, &high, x, 0);
+
+err:
+	bc_num_free(&e);
+	bc_num_free(&t);
+	bc_num_free(&pow);
+	return s;
 }
 
-static BcStatus bc_num_parseBase(BcNum *restrict n, const char *restrict val,
-                                 BcBigDig base)
+static BcStatus bc_num_d_newton(BcNum *restrict a, BcNum *restrict b,
+                                BcNum *restrict c, size_t scale)
 {
 	BcStatus s = BC_STATUS_SUCCESS;
-	BcNum temp, mult1, mult2, result1, result2, *m1, *m2, *ptr;
-	char c = 0;
-	bool zero = true;
-	BcBigDig v;
-	size_t i, digs, len = strlen(val);
+	BcNum n, dt, nt, x, q, r, t, high, one;
+	BcDig one_digs[1];
+	size_t rdx, m, p;
 
-	for (i = 0; zero && i < len; ++i) zero = (val[i] == '.' || val[i] == '0');
-	if (zero) return BC_STATUS_SUCCESS;
+	assert(!b->rdx && BC_NUM_NONZERO(b) && b->num[b->len - 1]);
 
-	bc_num_init(&temp, BC_NUM_BIGDIG_LOG10);
-	bc_num_init(&mult1, BC_NUM_BIGDIG_LOG10);
+	// The result is laid out exactly like bc_num_d_long() lays it out, so
+	// bc_num_d() can treat both the same.
+	bc_num_expand(c, a->len);
+	memset(c->num, 0, BC_NUM_SIZE(c->cap));
 
-	for (i = 0; i < len && (c = val[i]) && c != '.'; ++i) {
+	c->rdx = a->rdx;
+	c->scale = a->scale;
+	c->len = a->len;
 
-		v = bc_num_parseChar(c, base);
+	assert(c->scale >= scale);
+	rdx = c->rdx - BC_NUM_RDX(scale);
 
-		s = bc_num_mulArray(n, base, &mult1);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto int_err;
-		bc_num_bigdig2num(&temp, v);
-		s = bc_num_add(&mult1, &temp, n, 0);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto int_err;
-	}
+	// The BcDig's of a below rdx can never change the quotient BcDig's that
+	// are kept, so they are dropped, and n / b is computed on integers.
+	bc_num_divHigh(a, rdx, &n);
+	n.rdx = n.scale = 0;
 
-	if (i == len && !(c = val[i])) goto int_err;
+	m = b->len;
+	if (n.len < m) return s;
 
-	assert(c == '.');
-	bc_num_init(&mult2, BC_NUM_BIGDIG_LOG10);
-	bc_num_init(&result1, BC_NUM_DEF_SIZE);
-	bc_num_init(&result2, BC_NUM_DEF_SIZE);
-	bc_num_one(&mult1);
+	// The quotient has at most n.len - m + 1 BcDig's, and that, plus a couple
+	// of guard BcDig's, is all the precision that the reciprocal needs. Both n
+	// and b are shifted so that b has exactly p BcDig's.
+	p = bc_vm_growSize(n.len - m, 3);
 
-	m1 = &mult1;
-	m2 = &mult2;
+	if (m >= p) {
 
-	for (i += 1, digs = 0; BC_NO_SIG && i < len && (c = val[i]); ++i, ++digs) {
+		BcNum view;
 
-		v = bc_num_parseChar(c, base);
+		bc_num_toomPiece(b, m - p, p, &view);
+		bc_num_createCopy(&dt, &view);
+		bc_num_toomPiece(&n, m - p, n.len, &view);
+		bc_num_createCopy(&nt, &view);
+	}
+	else {
+		bc_num_createCopy(&dt, b);
+		bc_num_createCopy(&nt, &n);
+	}
 
-		s = bc_num_mulArray(&result1, base, &result2);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_init(&x, bc_vm_growSize(p, 2));
+	bc_num_init(&q, bc_vm_growSize(n.len, 1));
+	bc_num_init(&r, bc_vm_growSize(n.len, 1));
+	bc_num_init(&t, bc_vm_growSize(n.len, p));
+	bc_num_setup(&one, one_digs, sizeof(one_digs) / sizeof(BcDig));
+	bc_num_one(&one);
 
-		bc_num_bigdig2num(&temp, v);
-		s = bc_num_add(&result2, &temp, &result1, 0);
+	if (m < p) {
+		s = bc_num_shiftLeft(&dt, (p - m) * BC_BASE_DIGS);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-		s = bc_num_mulArray(m1, base, m2);
+		s = bc_num_shiftLeft(&nt, (p - m) * BC_BASE_DIGS);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-
-		if (m2->len < m2->rdx) m2->len = m2->rdx;
-
-		ptr = m1;
-		m1 = m2;
-		m2 = ptr;
 	}
 
-	if (BC_SIG) {
-		s = BC_STATUS_SIGNAL;
-		goto err;
-	}
+	s = bc_num_newtonInv(&dt, p, &x);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	// This one cannot be a divide by 0 because mult starts out at 1, then is
-	// multiplied by base, and base cannot be 0, so mult cannot be 0.
-	s = bc_num_div(&result1, m1, &result2, digs * 2);
-	assert(!s || s == BC_STATUS_SIGNAL);
+	// q = nt * x / BC_BASE_POW^(2p) is within a few units of the quotient.
+	s = bc_num_mul(&nt, &x, &t, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_divHigh(&t, 2 * p, &high);
+	bc_num_copy(&q, &high);
+
+	// The remainder fixes those units, so the quotient is truncated exactly
+	// like long division truncates it.
+	s = bc_num_mul(&q, b, &t, 0);
 	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-	bc_num_truncate(&result2, digs);
-	s = bc_num_add(n, &result2, n, digs);
+	s = bc_num_sub(&n, &t, &r, 0);
 	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	if (BC_NUM_NONZERO(n)) {
-		if (n->scale < digs) bc_num_extend(n, digs - n->scale);
+	while (BC_NO_SIG && r.neg) {
+		s = bc_num_sub(&q, &one, &q, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&r, b, &r, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 	}
-	else bc_num_zero(n);
-
-err:
-	bc_num_free(&result2);
-	bc_num_free(&result1);
-	bc_num_free(&mult2);
-int_err:
-	bc_num_free(&mult1);
-	bc_num_free(&temp);
-	return s;
-}
 
-static void bc_num_printNewline(void) {
-	if (vm->nchars >= (size_t) (vm->line_len - 1)) {
-		bc_vm_putchar('\\');
-		bc_vm_putchar('\n');
+	while (BC_NO_SIG && bc_num_cmp(&r, b) >= 0) {
+		s = bc_num_add(&q, &one, &q, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_sub(&r, b, &r, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 	}
-}
 
-static void bc_num_putchar(int c) {
-	if (c != '\n') bc_num_printNewline();
-	bc_vm_putchar(c);
-}
+	if (BC_SIG) goto err;
 
-#if DC_ENABLED
-static void bc_num_printChar(size_t n, size_t len, bool rdx) {
-	BC_UNUSED(rdx);
-	BC_UNUSED(len);
-	assert(len == 1);
-	bc_vm_putchar((uchar) n);
+	assert(!q.neg && q.len <= c->len - rdx);
+	memcpy(c->num + rdx, q.num, BC_NUM_SIZE(q.len));
+
+err:
+	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+	bc_num_free(&t);
+	bc_num_free(&r);
+	bc_num_free(&q);
+	bc_num_free(&x);
+	bc_num_free(&nt);
+	bc_num_free(&dt);
+	return s;
 }
-#endif // DC_ENABLED
 
-static void bc_num_printDigits(size_t n, size_t len, bool rdx) {
+static void bc_num_bzJoin(const BcNum *hi, const BcNum *lo, size_t n,
+                          BcNum *restrict c)
+{
+	size_t len;
 
-	size_t exp, pow;
+	assert(lo->len <= n);
 
-	bc_num_putchar(rdx ? '.' : ' ');
+	// This sets c to hi * BC_BASE_POW^n + lo.
+	len = bc_vm_growSize(hi->len, n);
+	bc_num_expand(c, len);
 
-	for (exp = 0, pow = 1; exp < len - 1; ++exp, pow *= BC_BASE);
+	memcpy(c->num, lo->num, BC_NUM_SIZE(lo->len));
+	memset(c->num + lo->len, 0, BC_NUM_SIZE(n - lo->len));
+	memcpy(c->num + n, hi->num, BC_NUM_SIZE(hi->len));
 
-	for (exp = 0; exp < len; pow /= BC_BASE, ++exp) {
-		size_t dig = n / pow;
-		n -= dig * pow;
-		bc_num_putchar(((uchar) dig) + '0');
-	}
+	c->len = len;
+	c->rdx = c->scale = 0;
+	c->neg = false;
+
+	bc_num_clean(c);
 }
 
-static void bc_num_printHex(size_t n, size_t len, bool rdx) {
+static BcStatus bc_num_bzBase(BcNum *a, BcNum *b, BcNum *restrict q,
+                              BcNum *restrict r)
+{
+	BcStatus s;
+	BcNum cpa;
+	ssize_t cmp;
 
-	BC_UNUSED(len);
+	cmp = bc_num_cmp(a, b);
 
-	assert(len == 1);
+#if BC_ENABLE_SIGNALS
+	if (BC_NUM_CMP_SIGNAL(cmp)) return BC_STATUS_SIGNAL;
+#endif // BC_ENABLE_SIGNALS
 
-	if (rdx) bc_num_putchar('.');
+	if (cmp < 0) {
+		bc_num_zero(q);
+		bc_num_copy(r, a);
+		return BC_STATUS_SUCCESS;
+	}
 
-	bc_num_putchar(bc_num_hex_digits[n]);
-}
+	// Because b is normalized, long division never has to shift its operands,
+	// so the remainder is what is left of the dividend.
+	bc_num_init(&cpa, bc_vm_growSize(a->len, 1));
+	bc_num_copy(&cpa, a);
+	cpa.num[cpa.len++] = 0;
 
-static void bc_num_printDecimal(const BcNum *restrict n) {
+	s = bc_num_d_long(&cpa, b, q, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	size_t i, j, rdx = n->rdx;
-	bool zero = true;
-	size_t buffer[BC_BASE_DIGS];
+	bc_num_clean(q);
+	bc_num_clean(&cpa);
+	bc_num_copy(r, &cpa);
 
-	if (n->neg) bc_num_putchar('-');
+err:
+	bc_num_free(&cpa);
+	return s;
+}
 
-	for (i = n->len - 1; i < n->len; --i) {
+static BcStatus bc_num_bzDiv32(BcNum *a, BcNum *b, size_t h,
+                               BcNum *restrict q, BcNum *restrict r);
 
-		BcDig n9 = n->num[i];
-		size_t temp;
-		bool irdx = (i == rdx - 1);
+static BcStatus bc_num_bzDiv21(BcNum *a, BcNum *b, size_t n,
+                               BcNum *restrict q, BcNum *restrict r)
+{
+	BcStatus s;
+	BcNum high, low, q1, q2, r1, t;
+	size_t h;
 
-		zero = (zero & !irdx);
-		temp = n->scale % BC_BASE_DIGS;
-		temp = i || !temp ? 0 : BC_BASE_DIGS - temp;
+	assert(b->len == n && a->len <= 2 * n);
 
-		memset(buffer, 0, BC_BASE_DIGS * sizeof(size_t));
+	if ((n & 1) || n <= BC_NUM_BZ_LEN) return bc_num_bzBase(a, b, q, r);
 
-		for (j = 0; n9 && j < BC_BASE_DIGS; ++j) {
-			buffer[j] = n9 % BC_BASE;
-			n9 /= BC_BASE;
-		}
+	// a is split into four pieces of h BcDig's, and the quotient is found
+	// with two 3-by-2 divisions, one for each half.
+	h = n / 2;
 
-		for (j = BC_BASE_DIGS - 1; j < BC_BASE_DIGS && j >= temp; --j) {
-			bool print_rdx = (irdx & (j == BC_BASE_DIGS - 1));
-			zero = (zero && buffer[j] == 0);
-			if (!zero) bc_num_printHex(buffer[j], 1, print_rdx);
-		}
-	}
-}
+	bc_num_init(&q1, bc_vm_growSize(h, 1));
+	bc_num_init(&q2, bc_vm_growSize(h, 1));
+	bc_num_init(&r1, bc_vm_growSize(n, 1));
+	bc_num_init(&t, bc_vm_growSize(n, h));
 
-#if BC_ENABLE_EXTRA_MATH
-static BcStatus bc_num_printExponent(const BcNum *restrict n, bool eng) {
+	bc_num_divHigh(a, h, &high);
 
-	BcStatus s = BC_STATUS_SUCCESS;
-	bool neg = (n->len <= n->rdx);
-	BcNum temp, exp;
-	size_t places, mod;
-	BcDig digs[BC_NUM_BIGDIG_LOG10];
+	s = bc_num_bzDiv32(&high, b, h, &q1, &r1);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	bc_num_createCopy(&temp, n);
+	bc_num_toomPiece(a, 0, h, &low);
+	bc_num_bzJoin(&r1, &low, h, &t);
 
-	if (neg) {
+	s = bc_num_bzDiv32(&t, b, h, &q2, r);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-		size_t i, idx = bc_num_nonzeroLen(n) - 1;
+	bc_num_bzJoin(&q1, &q2, h, q);
 
-		places = 1;
+err:
+	bc_num_free(&t);
+	bc_num_free(&r1);
+	bc_num_free(&q2);
+	bc_num_free(&q1);
+	return s;
+}
 
-		for (i = BC_BASE_DIGS - 1; i < BC_BASE_DIGS; --i) {
-			if (bc_num_pow10[i] > (BcBigDig) n->num[idx]) places += 1;
-			else break;
-		}
+static BcStatus bc_num_bzDiv32(BcNum *a, BcNum *b, size_t h,
+                               BcNum *restrict q, BcNum *restrict r)
+{
+	BcStatus s;
+	BcNum a1, a12, a3, b1, b2, r1, t, one;
+	BcDig one_digs[1];
+	ssize_t cmp;
+	size_t i;
 
-		places += (n->rdx - (idx + 1)) * BC_BASE_DIGS;
-		mod = places % 3;
+	assert(b->len == 2 * h && a->len <= 3 * h);
 
-		if (eng && mod != 0) places += 3 - mod;
-		s = bc_num_shiftLeft(&temp, places);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto exit;
+	bc_num_toomPiece(b, h, h, &b1);
+	bc_num_toomPiece(b, 0, h, &b2);
+	bc_num_divHigh(a, 2 * h, &a1);
+	bc_num_divHigh(a, h, &a12);
+	bc_num_toomPiece(a, 0, h, &a3);
+
+	bc_num_init(&r1, bc_vm_growSize(h, 1));
+	bc_num_init(&t, bc_vm_growSize(b->len, 1));
+	bc_num_setup(&one, one_digs, sizeof(one_digs) / sizeof(BcDig));
+	bc_num_one(&one);
+
+	cmp = bc_num_cmp(&a1, &b1);
+
+#if BC_ENABLE_SIGNALS
+	if (BC_NUM_CMP_SIGNAL(cmp)) {
+		s = BC_STATUS_SIGNAL;
+		goto err;
 	}
-	else {
-		places = bc_num_intDigits(n) - 1;
-		mod = places % 3;
-		if (eng && mod != 0) places -= 3 - (3 - mod);
-		s = bc_num_shiftRight(&temp, places);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto exit;
+#endif // BC_ENABLE_SIGNALS
+
+	// The quotient is estimated from the top of a and b1 alone. If the top of
+	// a is too big for that, the estimate is the biggest it could be,
+	// BC_BASE_POW^h - 1, and r1 = a12 - q * b1 is computed directly.
+	if (cmp < 0) {
+		s = bc_num_bzDiv21(&a12, &b1, h, q, &r1);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 	}
+	else {
 
-	bc_num_printDecimal(&temp);
-	bc_num_putchar('e');
+		bc_num_expand(q, h);
+		for (i = 0; i < h; ++i) q->num[i] = BC_BASE_POW - 1;
+		q->len = h;
+		q->rdx = q->scale = 0;
+		q->neg = false;
 
-	if (!places) {
-		bc_num_printHex(0, 1, false);
-		goto exit;
+		bc_num_zero(&t);
+		bc_num_bzJoin(&b1, &t, h, &r1);
+
+		s = bc_num_sub(&a12, &r1, &r1, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&r1, &b1, &r1, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 	}
 
-	if (neg) bc_num_putchar('-');
+	// The remainder is r1 * BC_BASE_POW^h + a3 - q * b2, and because b is
+	// normalized, q is at most two too big.
+	s = bc_num_mul(q, &b2, &t, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	bc_num_setup(&exp, digs, BC_NUM_BIGDIG_LOG10);
-	bc_num_bigdig2num(&exp, (BcBigDig) places);
+	bc_num_bzJoin(&r1, &a3, h, r);
 
-	bc_num_printDecimal(&exp);
+	s = bc_num_sub(r, &t, r, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-exit:
-	bc_num_free(&temp);
-	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+	while (BC_NO_SIG && r->neg) {
+		s = bc_num_sub(q, &one, q, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(r, b, r, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+
+err:
+	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+	bc_num_free(&t);
+	bc_num_free(&r1);
+	return s;
 }
-#endif // BC_ENABLE_EXTRA_MATH
 
-static BcStatus bc_num_printFixup(BcNum *restrict n, BcBigDig rem,
-                                  BcBigDig pow, size_t idx)
+static BcStatus bc_num_d_bz(BcNum *restrict a, BcNum *restrict b,
+                            BcNum *restrict c, size_t scale)
 {
-	size_t i, len = n->len - idx;
-	BcBigDig acc;
-	BcDig *a = n->num + idx;
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum n, d, num, z, qi, r, piece;
+	BcBigDig f;
+	size_t rdx, m, j, k, blk, t, i;
 
-	if (len < 2) return BC_STATUS_SUCCESS;
+	assert(!b->rdx && BC_NUM_NONZERO(b) && b->num[b->len - 1]);
 
-	for (i = len - 1; BC_NO_SIG && i > 0; --i) {
+	// This is Burnikel and Ziegler's recursive division. Like
+	// bc_num_d_newton(), it lays the result out like bc_num_d_long() does.
+	bc_num_expand(c, a->len);
+	memset(c->num, 0, BC_NUM_SIZE(c->cap));
 
-		acc = ((BcBigDig) a[i]) * rem + ((BcBigDig) a[i - 1]);
-		a[i - 1] = (BcDig) (acc % pow);
-		acc /= pow;
-		acc += (BcBigDig) a[i];
+	c->rdx = a->rdx;
+	c->scale = a->scale;
+	c->len = a->len;
 
-		if (acc >= BC_BASE_POW) {
+	assert(c->scale >= scale);
+	rdx = c->rdx - BC_NUM_RDX(scale);
 
-			if (i == len - 1) {
-				len = bc_vm_growSize(len, 1);
-				bc_num_expand(n, bc_vm_growSize(len, idx));
-				a = n->num + idx;
-				a[len - 1] = 0;
-			}
+	bc_num_divHigh(a, rdx, &n);
 
-			a[i + 1] += acc / BC_BASE_POW;
-			acc %= BC_BASE_POW;
-		}
+	m = b->len;
+	if (n.len < m) return s;
 
-		assert(acc < BC_BASE_POW);
-		a[i] = (BcDig) acc;
-	}
+	// The divisor is padded with zero BcDig's at the bottom until its length is
+	// a power of two times a number no bigger than BC_NUM_BZ_LEN, so it can be
+	// halved all the way down to long division. It is also multiplied by f to
+	// make its top BcDig at least half of BC_BASE_POW, which is what keeps the
+	// quotient estimates close. The dividend gets the same treatment, so the
+	// quotient does not change.
+	for (j = m, k = 0; j > BC_NUM_BZ_LEN; j = (j + 1) / 2, ++k);
+	blk = j << k;
+	assert(blk >= m);
 
-	n->len = len + idx;
+	f = BC_BASE_POW / ((BcBigDig) b->num[m - 1] + 1);
 
-	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+	bc_num_init(&d, bc_vm_growSize(blk, 1));
+	bc_num_init(&num, bc_vm_growSize(bc_vm_growSize(n.len, blk), 1));
+	bc_num_init(&z, bc_vm_growSize(blk, blk));
+	bc_num_init(&qi, bc_vm_growSize(blk, 1));
+	bc_num_init(&r, bc_vm_growSize(blk, 1));
+
+	s = bc_num_mulArray(b, f, &d);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mulArray(&n, f, &num);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_shiftLeft(&d, (blk - m) * BC_BASE_DIGS);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_shiftLeft(&num, (blk - m) * BC_BASE_DIGS);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	assert(d.len == blk && d.num[blk - 1] >= BC_BASE_POW / 2);
+
+	// The dividend is divided a block of blk BcDig's at a time, and each
+	// remainder is carried into the next block.
+	t = (num.len + blk - 1) / blk;
+
+	for (i = t - 1; BC_NO_SIG && i < t; --i) {
+
+		bc_num_toomPiece(&num, i * blk, blk, &piece);
+		bc_num_bzJoin(&r, &piece, blk, &z);
+
+		s = bc_num_bzDiv21(&z, &d, blk, &qi, &r);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+		if (BC_NUM_NONZERO(&qi)) {
+			assert(rdx + i * blk + qi.len <= c->len);
+			memcpy(c->num + rdx + i * blk, qi.num, BC_NUM_SIZE(qi.len));
+		}
+	}
+
+err:
+	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+	bc_num_free(&r);
+	bc_num_free(&qi);
+	bc_num_free(&z);
+	bc_num_free(&num);
+	bc_num_free(&d);
+	return s;
 }
 
-static BcStatus bc_num_printPrepare(BcNum *restrict n, BcBigDig rem,
-                                    BcBigDig pow)
-{
+static BcStatus bc_num_d(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
+
 	BcStatus s = BC_STATUS_SUCCESS;
-	size_t i;
+	size_t len, mark;
+	BcNum cpa, cpb;
 
-	for (i = 0; BC_NO_SIG && BC_NO_ERR(!s) && i < n->len; ++i)
-		s = bc_num_printFixup(n, rem, pow, i);
+	if (BC_NUM_ZERO(b)) return bc_vm_err(BC_ERROR_MATH_DIVIDE_BY_ZERO);
+	if (BC_NUM_ZERO(a)) {
+		bc_num_setToZero(c, scale);
+		return BC_STATUS_SUCCESS;
+	}
+	if (BC_NUM_ONE(b)) {
+		bc_num_copy(c, a);
+		bc_num_retireMul(c, scale, a->neg, b->neg);
+		return BC_STATUS_SUCCESS;
+	}
+	if (!a->rdx && !b->rdx && b->len == 1 && !scale) {
+		BcBigDig rem;
+		s = bc_num_divArray(a, (BcBigDig) b->num[0], c, &rem);
+		bc_num_retireMul(c, scale, a->neg, b->neg);
+		return s;
+	}
 
-	if (BC_ERR(s)) return s;
+	mark = vm->arena_len;
 
-	for (i = 0; BC_NO_SIG && i < n->len; ++i) {
+	len = bc_num_mulReq(a, b, scale);
+	bc_num_initTemp(&cpa, len);
+	bc_num_copy(&cpa, a);
+	bc_num_initTemp(&cpb, b->len);
+	bc_num_copy(&cpb, b);
 
-		assert(pow == ((BcBigDig) ((BcDig) pow)));
+	len = b->len;
 
-		if (n->num[i] >= (BcDig) pow) {
+	if (len > cpa.len) {
+		bc_num_expand(&cpa, bc_vm_growSize(len, 2));
+		bc_num_extend(&cpa, (len - cpa.len) * BC_BASE_DIGS);
+	}
 
-			if (i + 1 == n->len) {
-				n->len = bc_vm_growSize(n->len, 1);
-				bc_num_expand(n, n->len);
-				n->num[i + 1] = 0;
-			}
+	cpa.scale = cpa.rdx * BC_BASE_DIGS;
 
-			assert(pow < BC_BASE_POW);
-			n->num[i + 1] += n->num[i] / ((BcDig) pow);
-			n->num[i] %= (BcDig) pow;
-		}
+	bc_num_extend(&cpa, b->scale);
+	cpa.rdx -= BC_NUM_RDX(b->scale);
+	cpa.scale = cpa.rdx * BC_BASE_DIGS;
+
+	if (scale > cpa.scale) {
+		bc_num_extend(&cpa, scale);
+		cpa.scale = cpa.rdx * BC_BASE_DIGS;
 	}
 
-	return BC_NO_ERR(!s) && BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+	if (cpa.cap == cpa.len) bc_num_expand(&cpa, bc_vm_growSize(cpa.len, 1));
+
+	// We want an extra zero in front to make things simpler.
+	cpa.num[cpa.len++] = 0;
+
+	if (cpa.rdx == cpa.len) cpa.len = bc_num_nonzeroLen(&cpa);
+	if (cpb.rdx == cpb.len) cpb.len = bc_num_nonzeroLen(&cpb);
+	cpb.scale = cpb.rdx = 0;
+	cpa.neg = cpb.neg = false;
+
+	// Long division is quadratic in the length of the quotient times the length
+	// of the divisor, so it is only worth it to use Burnikel-Ziegler or
+	// Newton's method when both are big. len is the number of BcDig's of the
+	// dividend that matter.
+	len = cpa.len - (cpa.rdx - BC_NUM_RDX(scale));
+
+	if (cpb.len >= BC_NUM_NEWTON_LEN &&
+	    len >= bc_vm_growSize(cpb.len, BC_NUM_NEWTON_LEN))
+	{
+		s = bc_num_d_newton(&cpa, &cpb, c, scale);
+	}
+	else if (cpb.len >= BC_NUM_BZ_LEN &&
+	         len >= bc_vm_growSize(cpb.len, BC_NUM_BZ_LEN))
+	{
+		s = bc_num_d_bz(&cpa, &cpb, c, scale);
+	}
+	else s = bc_num_d_long(&cpa, &cpb, c, scale);
+
+	if (BC_NO_ERR(!s)) {
+		if (BC_SIG) s = BC_STATUS_SIGNAL;
+		else bc_num_retireMul(c, scale, a->neg, b->neg);
+	}
+
+	bc_num_free(&cpb);
+	bc_num_free(&cpa);
+	bc_vm_arenaRelease(mark);
+
+	return s;
 }
 
-static BcStatus bc_num_printNum(BcNum *restrict n, BcBigDig base,
-                                size_t len, BcNumDigitOp print)
+static BcStatus bc_num_r(BcNum *a, BcNum *b, BcNum *restrict c,
+                         BcNum *restrict d, size_t scale, size_t ts)
 {
 	BcStatus s;
-	BcVec stack;
-	BcNum intp, fracp1, fracp2, digit, flen1, flen2, *n1, *n2, *temp;
-	BcBigDig dig = 0, *ptr, acc, exp;
-	size_t i, j;
-	bool radix;
-	BcDig digit_digs[BC_NUM_BIGDIG_LOG10 + 1];
-
-	assert(base > 1);
+	BcNum temp;
+	size_t mark;
+	bool neg;
 
-	if (BC_NUM_ZERO(n)) {
-		print(0, len, false);
+	if (BC_NUM_ZERO(b)) return bc_vm_err(BC_ERROR_MATH_DIVIDE_BY_ZERO);
+	if (BC_NUM_ZERO(a)) {
+		bc_num_setToZero(c, ts);
+		bc_num_setToZero(d, ts);
 		return BC_STATUS_SUCCESS;
 	}
 
-	// This function uses an algorithm that Stefan Esser <se@freebsd.org> came
-	// up with to print the integer part of a number. What it does is convert
-	// intp into a number of the specified base, but it does it directly,
-	// instead of just doing a series of divisions and printing the remainders
-	// in reverse order.
-	//
-	// Let me explain in a bit more detail:
-	//
-	// The algorithm takes the current least significant digit (after intp has
+	mark = vm->arena_len;
+
+	bc_num_initTemp(&temp, d->cap);
+	s = bc_num_d(a, b, c, scale);
+	assert(!s || s == BC_STATUS_SIGNAL);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	if (scale) scale = ts + 1;
+
+	s = bc_num_m(c, b, &temp, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_sub(a, &temp, d, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	if (ts > d->scale && BC_NUM_NONZERO(d)) bc_num_extend(d, ts - d->scale);
+
+	neg = d->neg;
+	bc_num_retireMul(d, ts, a->neg, b->neg);
+	d->neg = BC_NUM_NONZERO(d) ? neg : false;
+
+err:
+	bc_num_free(&temp);
+	bc_vm_arenaRelease(mark);
+	return s;
+}
+
+static BcStatus bc_num_rem(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale)
+{
+	BcStatus s;
+	BcNum c1;
+	size_t ts, mark = vm->arena_len;
+
+	ts = bc_vm_growSize(scale, b->scale);
+	ts = BC_MAX(ts, a->scale);
+
+	bc_num_initTemp(&c1, bc_num_mulReq(a, b, ts));
+	s = bc_num_r(a, b, &c1, c, scale, ts);
+	bc_num_free(&c1);
+	bc_vm_arenaRelease(mark);
+
+	return s;
+}
+
+static BcStatus bc_num_p(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum copy;
+	BcBigDig pow = 0;
+	size_t i, powrdx, resrdx;
+	bool neg, zero;
+
+	if (BC_ERR(b->rdx)) return bc_vm_err(BC_ERROR_MATH_NON_INTEGER);
+
+	if (BC_NUM_ZERO(b)) {
+		bc_num_one(c);
+		return BC_STATUS_SUCCESS;
+	}
+	if (BC_NUM_ZERO(a)) {
+		if (b->neg) return bc_vm_err(BC_ERROR_MATH_DIVIDE_BY_ZERO);
+		bc_num_setToZero(c, scale);
+		return BC_STATUS_SUCCESS;
+	}
+	if (BC_NUM_ONE(b)) {
+		if (!b->neg) bc_num_copy(c, a);
+		else s = bc_num_inv(a, c, scale);
+		return s;
+	}
+
+	neg = b->neg;
+	b->neg = false;
+	s = bc_num_bigdig(b, &pow);
+	b->neg = neg;
+	if (s) return s;
+
+	bc_num_createCopy(&copy, a);
+
+	if (!neg) {
+		size_t max = BC_MAX(scale, a->scale), scalepow = a->scale * pow;
+		scale = BC_MIN(scalepow, max);
+	}
+
+	// The products are exact, except for the last one, which is truncated to
+	// scale below anyway, so it can be truncated by the multiplication.
+	for (powrdx = a->scale; BC_NO_SIG && !(pow & 1); pow >>= 1) {
+		powrdx <<= 1;
+		s = bc_num_mul(&copy, &copy, &copy,
+		               !neg && pow == 2 ? scale : powrdx);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+
+	if (BC_SIG) goto sig_err;
+
+	bc_num_copy(c, &copy);
+	resrdx = powrdx;
+
+	while (BC_NO_SIG && (pow >>= 1)) {
+
+		powrdx <<= 1;
+		s = bc_num_mul(&copy, &copy, &copy, powrdx);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+		if (pow & 1) {
+			resrdx += powrdx;
+			s = bc_num_mul(c, &copy, c, !neg && pow == 1 ? scale : resrdx);
+			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		}
+	}
+
+	if (BC_SIG) goto sig_err;
+	if (neg) {
+		s = bc_num_inv(c, c, scale);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+
+	if (c->scale > scale) bc_num_truncate(c, c->scale - scale);
+
+	// We can't use bc_num_clean() here.
+	for (zero = true, i = 0; zero && i < c->len; ++i) zero = !c->num[i];
+	if (zero) bc_num_setToZero(c, scale);
+
+sig_err:
+	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+err:
+	bc_num_free(&copy);
+	return s;
+}
+
+#if BC_ENABLE_EXTRA_MATH
+static BcStatus bc_num_place(BcNum *a, BcNum *b, BcNum *restrict c,
+                             size_t scale)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcBigDig val = 0;
+
+	BC_UNUSED(scale);
+
+	s = bc_num_intop(a, b, c, &val);
+	if (BC_ERR(s)) return s;
+
+	if (val < c->scale) bc_num_truncate(c, c->scale - val);
+	else if (val > c->scale) bc_num_extend(c, val - c->scale);
+
+	return s;
+}
+
+static BcStatus bc_num_left(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcBigDig val = 0;
+
+	BC_UNUSED(scale);
+
+	s = bc_num_intop(a, b, c, &val);
+	if (BC_ERR(s)) return s;
+
+	return bc_num_shiftLeft(c, (size_t) val);
+}
+
+static BcStatus bc_num_right(BcNum *a, BcNum *b, BcNum *restrict c,
+                             size_t scale)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcBigDig val = 0;
+
+	BC_UNUSED(scale);
+
+	s = bc_num_intop(a, b, c, &val);
+	if (BC_ERR(s)) return s;
+
+	if (BC_NUM_ZERO(c)) return s;
+
+	return bc_num_shiftRight(c, (size_t) val);
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
+#if BC_ENABLED
+
+static BcBigDig bc_num_gcdDig(BcBigDig a, BcBigDig b) {
+
+	while (b) {
+		BcBigDig t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+static BcStatus bc_num_lehmer(BcNum *restrict x, BcNum *restrict y,
+                              BcNum *restrict t1, BcNum *restrict t2,
+                              BcNum *restrict r1, BcNum *restrict r2)
+{
+	BcStatus s;
+	BcBigDig xh, yh, q, r, m00 = 1, m01 = 0, m10 = 0, m11 = 1, n00, n10;
+	size_t i = x->len - 2;
+
+	assert(x->len > 2 && BC_NUM_NONZERO(y) && bc_num_cmp(x, y) >= 0);
+
+	// Euclid's algorithm is run on the top two limbs of both numbers, and the
+	// quotients are gathered in a matrix M such that (x, y) = M * (x', y').
+	xh = ((BcBigDig) x->num[i + 1]) * BC_BASE_POW + (BcBigDig) x->num[i];
+	yh = y->len > i + 1 ? ((BcBigDig) y->num[i + 1]) * BC_BASE_POW : 0;
+	yh += y->len > i ? (BcBigDig) y->num[i] : 0;
+
+	while (yh) {
+
+		q = xh / yh;
+		if (q >= BC_BASE_POW) break;
+
+		r = xh - q * yh;
+		n00 = q * m00 + m01;
+		n10 = q * m10 + m11;
+
+		// This is Jebelean's condition, which makes sure that the quotient
+		// is the same one that the whole numbers would have. The cofactors
+		// also have to fit in one limb.
+		if (n00 >= BC_BASE_POW || n10 >= BC_BASE_POW) break;
+		if (r < n00 || yh - r < n00 + m00) break;
+
+		m01 = m00;
+		m00 = n00;
+		m11 = m10;
+		m10 = n10;
+		xh = yh;
+		yh = r;
+	}
+
+	if (m01) {
+
+		// Since the determinant of M is 1 or -1, x' and y' are the absolute
+		// values of m11 * x - m01 * y and m00 * y - m10 * x.
+		s = bc_num_mulArray(x, m11, t1);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+		s = bc_num_mulArray(y, m01, t2);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+		s = bc_num_sub(t1, t2, r1, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+		s = bc_num_mulArray(y, m00, t1);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+		s = bc_num_mulArray(x, m10, t2);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+		s = bc_num_sub(t1, t2, r2, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+		r1->neg = r2->neg = false;
+
+		// The new pair always has the same gcd, but it is only used if it is
+		// smaller, which it always is unless a quotient was wrong.
+		if (bc_num_cmp(r1, x) < 0 && bc_num_cmp(r2, x) < 0) {
+			bc_num_swap(x, r1);
+			bc_num_swap(y, r2);
+			if (bc_num_cmp(x, y) < 0) bc_num_swap(x, y);
+			return s;
+		}
+	}
+
+	// This is one step of Euclid's algorithm on the whole numbers.
+	s = bc_num_rem(x, y, r1, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+	bc_num_swap(x, y);
+	bc_num_swap(y, r1);
+
+	return s;
+}
+
+static BcStatus bc_num_g(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum x, y, t1, t2, r1, r2;
+	size_t len;
+
+	BC_UNUSED(scale);
+
+	if (BC_ERR(a->rdx || b->rdx)) return bc_vm_err(BC_ERROR_MATH_NON_INTEGER);
+
+	len = bc_vm_growSize(BC_MAX(a->len, b->len), 1);
+
+	bc_num_createCopy(&x, a);
+	bc_num_createCopy(&y, b);
+	bc_num_init(&t1, len);
+	bc_num_init(&t2, len);
+	bc_num_init(&r1, len);
+	bc_num_init(&r2, len);
+
+	x.neg = y.neg = false;
+	if (bc_num_cmp(&x, &y) < 0) bc_num_swap(&x, &y);
+
+	while (BC_NO_SIG && BC_NUM_NONZERO(&y)) {
+
+		// This is the last step, after which the numbers fit in machine words.
+		if (x.len <= 2) {
+
+			BcBigDig xd = 0, yd = 0;
+
+			s = bc_num_bigdig(&x, &xd);
+			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+			s = bc_num_bigdig(&y, &yd);
+			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+			bc_num_bigdig2num(&x, bc_num_gcdDig(xd, yd));
+
+			break;
+		}
+
+		s = bc_num_lehmer(&x, &y, &t1, &t2, &r1, &r2);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	}
+
+	if (BC_SIG) {
+		s = BC_STATUS_SIGNAL;
+		goto err;
+	}
+
+	bc_num_copy(c, &x);
+
+err:
+	bc_num_free(&r2);
+	bc_num_free(&r1);
+	bc_num_free(&t2);
+	bc_num_free(&t1);
+	bc_num_free(&y);
+	bc_num_free(&x);
+	return s;
+}
+
+static BcStatus bc_num_l(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
+
+	BcStatus s;
+	BcNum g, temp;
+
+	BC_UNUSED(scale);
+
+	if (BC_ERR(a->rdx || b->rdx)) return bc_vm_err(BC_ERROR_MATH_NON_INTEGER);
+
+	if (BC_NUM_ZERO(a) || BC_NUM_ZERO(b)) {
+		bc_num_setToZero(c, 0);
+		return BC_STATUS_SUCCESS;
+	}
+
+	bc_num_init(&g, BC_MAX(a->len, b->len));
+	bc_num_init(&temp, a->len);
+
+	s = bc_num_g(a, b, &g, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// The gcd divides a exactly, so this is the smaller multiplication.
+	s = bc_num_div(a, &g, &temp, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mul(&temp, b, c, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	c->neg = false;
+
+err:
+	bc_num_free(&temp);
+	bc_num_free(&g);
+	return s;
+}
+#endif // BC_ENABLED
+
+static BcStatus bc_num_binary(BcNum *a, BcNum *b, BcNum *c, size_t scale,
+                              BcNumBinaryOp op, size_t req)
+{
+	BcStatus s;
+	BcNum num2, *ptr_a, *ptr_b;
+	bool init = false;
+
+	assert(a != NULL && b != NULL && c != NULL && op != NULL);
+
+	if (c == a) {
+		ptr_a = &num2;
+		bc_num_move(ptr_a, c);
+		init = true;
+	}
+	else ptr_a = a;
+
+	if (c == b) {
+		ptr_b = &num2;
+		if (c != a) {
+			bc_num_move(ptr_b, c);
+			init = true;
+		}
+	}
+	else ptr_b = b;
+
+	if (init) bc_num_init(c, req);
+	else bc_num_expand(c, req);
+
+	s = op(ptr_a, ptr_b, c, scale);
+
+	assert(!c->neg || BC_NUM_NONZERO(c));
+	assert(c->rdx <= c->len || !c->len || s);
+	assert(!c->len || c->num[c->len - 1] || c->rdx == c->len);
+
+	if (init) bc_num_free(&num2);
+
+	return s;
+}
+
+#ifndef NDEBUG
+static bool bc_num_strValid(const char *val) {
+
+	bool radix = false;
+	size_t i, len = strlen(val);
+
+	if (!len) return true;
+
+	for (i = 0; i < len; ++i) {
+
+		BcDig c = val[i];
+
+		if (c == '.') {
+
+			if (radix) return false;
+
+			radix = true;
+			continue;
+		}
+
+		if (!(isdigit(c) || isupper(c))) return false;
+	}
+
+	return true;
+}
+#endif // NDEBUG
+
+static BcBigDig bc_num_parseChar(char c, size_t base_t) {
+
+	if (isupper(c)) {
+		c = BC_NUM_NUM_LETTER(c);
+		c = ((size_t) c) >= base_t ? (char) base_t - 1 : c;
+	}
+	else c -= '0';
+
+	return (BcBigDig) (uchar) c;
+}
+
+static void bc_num_parseDecimal(BcNum *restrict n, const char *restrict val) {
+
+	size_t len, i, temp, mod;
+	const char *ptr;
+	bool zero = true, rdx;
+
+	for (i = 0; val[i] == '0'; ++i);
+
+	val += i;
+	assert(!val[0] || isalnum(val[0]) || val[0] == '.');
+
+	// All 0's. We can just return, since this
+	// procedure expects a virgin (already 0) BcNum.
+	if (!val[0]) return;
+
+	len = strlen(val);
+
+	ptr = strchr(val, '.');
+	rdx = (ptr != NULL);
+
+	for (i = 0; i < len && (zero = (val[i] == '0' || val[i] == '.')); ++i);
+
+	n->scale = (size_t) (rdx * ((val + len) - (ptr + 1)));
+	n->rdx = BC_NUM_RDX(n->scale);
+
+	i = len - (ptr == val ? 0 : i) - rdx;
+	temp = BC_NUM_ROUND_POW(i);
+	mod = n->scale % BC_BASE_DIGS;
+	i = mod ? BC_BASE_DIGS - mod : 0;
+	n->len = ((temp + i) / BC_BASE_DIGS);
+
+	bc_num_expand(n, n->len);
+	memset(n->num, 0, BC_NUM_SIZE(n->len));
+
+	if (zero) n->len = n->rdx = 0;
+	else {
+
+		BcBigDig exp, pow;
+
+		assert(i <= BC_NUM_BIGDIG_MAX);
+
+		exp = (BcBigDig) i;
+		pow = bc_num_pow10[exp];
+
+		for (i = len - 1; i < len; --i, ++exp) {
+
+			char c = val[i];
+
+			if (c == '.') exp -= 1;
+			else {
+
+				size_t idx = exp / BC_BASE_DIGS;
+
+				if (isupper(c)) c = '9';
+				n->num[idx] += (((BcBigDig) c) - '0') * pow;
+
+				if ((exp + 1) % BC_BASE_DIGS == 0) pow = 1;
+				else pow *= BC_BASE;
+			}
+		}
+	}
+}
+
+static void bc_num_mulAddArray(BcNum *restrict n, BcBigDig mul, BcBigDig add) {
+
+	size_t i;
+	BcBigDig carry = add;
+
+	assert(!n->rdx && mul <= BC_BASE_POW);
+
+	bc_num_expand(n, bc_vm_growSize(n->len, 2));
+
+	for (i = 0; i < n->len; ++i) {
+		BcBigDig in = ((BcBigDig) n->num[i]) * mul + carry;
+		n->num[i] = (BcDig) (in % BC_BASE_POW);
+		carry = in / BC_BASE_POW;
+	}
+
+	for (; carry; carry /= BC_BASE_POW)
+		n->num[n->len++] = (BcDig) (carry % BC_BASE_POW);
+}
+
+static BcStatus bc_num_parseWords(BcNum *restrict n, const char *restrict val,
+                                  size_t len, BcBigDig base, size_t word)
+{
+	size_t i, j, cnt;
+	BcBigDig dig, mul;
+
+	// The digits are put together in words of word digits, which is as many
+	// as fit in one BcDig, and each word is added in with one pass over n. The
+	// first word takes the digits that are left over.
+	for (i = 0; BC_NO_SIG && i < len; i += cnt) {
+
+		cnt = i ? word : len - (len - 1) / word * word;
+
+		for (j = 0, dig = 0, mul = 1; j < cnt; ++j) {
+			dig = dig * base + bc_num_parseChar(val[i + j], base);
+			mul *= base;
+		}
+
+		bc_num_mulAddArray(n, mul, dig);
+	}
+
+	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+}
+
+static BcStatus bc_num_parseDC(BcNum *restrict n, const char *restrict val,
+                               size_t len, BcBigDig base, size_t word,
+                               BcVec *restrict pows)
+{
+	BcStatus s;
+	BcNum hi, lo, temp, *pow;
+	size_t i, plen;
+
+	// This is here because the function is recursive.
+	if (BC_SIG) return BC_STATUS_SIGNAL;
+
+	if (len <= word * BC_NUM_PARSE_LEN)
+		return bc_num_parseWords(n, val, len, base, word);
+
+	// The low plen digits, where plen is the biggest word * 2^i less than len,
+	// are parsed apart from the rest, and the rest is multiplied by pows[i],
+	// which is base^plen. pows holds base^word and its repeated squares, which
+	// are only computed when they are needed.
+	for (i = 0, plen = word; plen * 2 < len; ++i, plen *= 2);
+
+	while (pows->len <= i) {
+
+		BcNum sqr;
+
+		pow = bc_vec_top(pows);
+		bc_num_init(&sqr, bc_vm_arraySize(2, pow->len));
+
+		s = bc_num_mul(pow, pow, &sqr, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) {
+			bc_num_free(&sqr);
+			return s;
+		}
+
+		bc_vec_push(pows, &sqr);
+	}
+
+	pow = bc_vec_item(pows, i);
+
+	bc_num_init(&hi, BC_NUM_DEF_SIZE);
+	bc_num_init(&lo, pow->len);
+	bc_num_init(&temp, bc_vm_growSize(pow->len, pow->len));
+
+	s = bc_num_parseDC(&hi, val, len - plen, base, word, pows);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_parseDC(&lo, val + len - plen, plen, base, word, pows);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	s = bc_num_mul(&hi, pow, &temp, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(&temp, &lo, n, 0);
+
+err:
+	bc_num_free(&temp);
+	bc_num_free(&lo);
+	bc_num_free(&hi);
+	return s;
+}
+
+static BcStatus bc_num_parseInt(BcNum *restrict n, const char *restrict val,
+                                size_t len, BcBigDig base)
+{
+	BcStatus s;
+	BcVec pows;
+	BcNum pow;
+	BcBigDig mul;
+	size_t word;
+
+	for (word = 1, mul = base; mul * base <= BC_BASE_POW; ++word, mul *= base);
+
+	// Small literals, which are the common case, are parsed word by word, and
+	// big ones with divide and conquer.
+	if (len <= word * BC_NUM_PARSE_LEN)
+		return bc_num_parseWords(n, val, len, base, word);
+
+	bc_vec_init(&pows, sizeof(BcNum), bc_num_free);
+
+	bc_num_init(&pow, BC_NUM_BIGDIG_LOG10);
+	bc_num_bigdig2num(&pow, mul);
+	bc_vec_push(&pows, &pow);
+
+	s = bc_num_parseDC(n, val, len, base, word, &pows);
+
+	bc_vec_free(&pows);
+
+	return s;
+}
+
+static BcStatus bc_num_parseBase(BcNum *restrict n, const char *restrict val,
+                                 BcBigDig base)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum temp, pow, frac, result;
+	bool zero = true;
+	size_t i, digs, len = strlen(val);
+
+	for (i = 0; zero && i < len; ++i) zero = (val[i] == '.' || val[i] == '0');
+	if (zero) return BC_STATUS_SUCCESS;
+
+	for (i = 0; i < len && val[i] != '.'; ++i);
+
+	s = bc_num_parseInt(n, val, i, base);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+	if (i == len) return s;
+
+	assert(val[i] == '.');
+
+	// The fraction is parsed as an integer, and then it is divided by
+	// base^digs, where digs is the number of digits it has.
+	digs = len - i - 1;
+
+	bc_num_init(&temp, BC_NUM_BIGDIG_LOG10);
+	bc_num_init(&pow, BC_NUM_DEF_SIZE);
+	bc_num_init(&frac, BC_NUM_DEF_SIZE);
+	bc_num_init(&result, BC_NUM_DEF_SIZE);
+
+	s = bc_num_parseInt(&frac, val + i + 1, digs, base);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	bc_num_bigdig2num(&temp, (BcBigDig) digs);
+	bc_num_bigdig2num(&pow, base);
+
+	s = bc_num_pow(&pow, &temp, &pow, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// This one cannot be a divide by 0 because base cannot be 0, so pow
+	// cannot be 0 either.
+	s = bc_num_div(&frac, &pow, &result, digs);
+	assert(!s || s == BC_STATUS_SIGNAL);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(n, &result, n, digs);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	if (BC_NUM_NONZERO(n)) {
+		if (n->scale < digs) bc_num_extend(n, digs - n->scale);
+	}
+	else bc_num_zero(n);
+
+err:
+	bc_num_free(&result);
+	bc_num_free(&frac);
+	bc_num_free(&pow);
+	bc_num_free(&temp);
+	return s;
+}
+
+static void bc_num_printNewline(void) {
+	if (vm->nchars >= (size_t) (vm->line_len - 1)) {
+		bc_vm_putchar('\\');
+		bc_vm_putchar('\n');
+	}
+}
+
+static void bc_num_putchar(int c) {
+	if (c != '\n') bc_num_printNewline();
+	bc_vm_putchar(c);
+}
+
+#if DC_ENABLED
+static void bc_num_printChar(size_t n, size_t len, bool rdx) {
+	BC_UNUSED(rdx);
+	BC_UNUSED(len);
+	assert(len == 1);
+	bc_vm_putchar((uchar) n);
+}
+#endif // DC_ENABLED
+
+static void bc_num_printDigits(size_t n, size_t len, bool rdx) {
+
+	size_t exp, pow;
+
+	bc_num_putchar(rdx ? '.' : ' ');
+
+	for (exp = 0, pow = 1; exp < len - 1; ++exp, pow *= BC_BASE);
+
+	for (exp = 0; exp < len; pow /= BC_BASE, ++exp) {
+		size_t dig = n / pow;
+		n -= dig * pow;
+		bc_num_putchar(((uchar) dig) + '0');
+	}
+}
+
+static void bc_num_printHex(size_t n, size_t len, bool rdx) {
+
+	BC_UNUSED(len);
+
+	assert(len == 1);
+
+	if (rdx) bc_num_putchar('.');
+
+	bc_num_putchar(bc_num_hex_digits[n]);
+}
+
+static void bc_num_printDecimal(const BcNum *restrict n) {
+
+	size_t i, j, rdx = n->rdx;
+	bool zero = true;
+	size_t buffer[BC_BASE_DIGS];
+
+	if (n->neg) bc_num_putchar('-');
+
+	for (i = n->len - 1; i < n->len; --i) {
+
+		BcDig n9 = n->num[i];
+		size_t temp;
+		bool irdx = (i == rdx - 1);
+
+		zero = (zero & !irdx);
+		temp = n->scale % BC_BASE_DIGS;
+		temp = i || !temp ? 0 : BC_BASE_DIGS - temp;
+
+		memset(buffer, 0, BC_BASE_DIGS * sizeof(size_t));
+
+		for (j = 0; n9 && j < BC_BASE_DIGS; ++j) {
+			buffer[j] = n9 % BC_BASE;
+			n9 /= BC_BASE;
+		}
+
+		for (j = BC_BASE_DIGS - 1; j < BC_BASE_DIGS && j >= temp; --j) {
+			bool print_rdx = (irdx & (j == BC_BASE_DIGS - 1));
+			zero = (zero && buffer[j] == 0);
+			if (!zero) bc_num_printHex(buffer[j], 1, print_rdx);
+		}
+	}
+}
+
+#if BC_ENABLE_EXTRA_MATH
+static BcStatus bc_num_printExponent(const BcNum *restrict n, bool eng) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	bool neg = (n->len <= n->rdx);
+	BcNum temp, exp;
+	size_t places, mod;
+	BcDig digs[BC_NUM_BIGDIG_LOG10];
+
+	bc_num_createCopy(&temp, n);
+
+	if (neg) {
+
+		size_t i, idx = bc_num_nonzeroLen(n) - 1;
+
+		places = 1;
+
+		for (i = BC_BASE_DIGS - 1; i < BC_BASE_DIGS; --i) {
+			if (bc_num_pow10[i] > (BcBigDig) n->num[idx]) places += 1;
+			else break;
+		}
+
+		places += (n->rdx - (idx + 1)) * BC_BASE_DIGS;
+		mod = places % 3;
+
+		if (eng && mod != 0) places += 3 - mod;
+		s = bc_num_shiftLeft(&temp, places);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto exit;
+	}
+	else {
+		places = bc_num_intDigits(n) - 1;
+		mod = places % 3;
+		if (eng && mod != 0) places -= 3 - (3 - mod);
+		s = bc_num_shiftRight(&temp, places);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto exit;
+	}
+
+	bc_num_printDecimal(&temp);
+	bc_num_putchar('e');
+
+	if (!places) {
+		bc_num_printHex(0, 1, false);
+		goto exit;
+	}
+
+	if (neg) bc_num_putchar('-');
+
+	bc_num_setup(&exp, digs, BC_NUM_BIGDIG_LOG10);
+	bc_num_bigdig2num(&exp, (BcBigDig) places);
+
+	bc_num_printDecimal(&exp);
+
+exit:
+	bc_num_free(&temp);
+	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
+static BcStatus bc_num_printFixup(BcNum *restrict n, BcBigDig rem,
+                                  BcBigDig pow, size_t idx)
+{
+	size_t i, len = n->len - idx;
+	BcBigDig acc;
+	BcDig *a = n->num + idx;
+
+	if (len < 2) return BC_STATUS_SUCCESS;
+
+	for (i = len - 1; BC_NO_SIG && i > 0; --i) {
+
+		acc = ((BcBigDig) a[i]) * rem + ((BcBigDig) a[i - 1]);
+		a[i - 1] = (BcDig) (acc % pow);
+		acc /= pow;
+		acc += (BcBigDig) a[i];
+
+		if (acc >= BC_BASE_POW) {
+
+			if (i == len - 1) {
+				len = bc_vm_growSize(len, 1);
+				bc_num_expand(n, bc_vm_growSize(len, idx));
+				a = n->num + idx;
+				a[len - 1] = 0;
+			}
+
+			a[i + 1] += acc / BC_BASE_POW;
+			acc %= BC_BASE_POW;
+		}
+
+		assert(acc < BC_BASE_POW);
+		a[i] = (BcDig) acc;
+	}
+
+	n->len = len + idx;
+
+	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+}
+
+static BcStatus bc_num_printPrepare(BcNum *restrict n, BcBigDig rem,
+                                    BcBigDig pow)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	size_t i;
+
+	for (i = 0; BC_NO_SIG && BC_NO_ERR(!s) && i < n->len; ++i)
+		s = bc_num_printFixup(n, rem, pow, i);
+
+	if (BC_ERR(s)) return s;
+
+	for (i = 0; BC_NO_SIG && i < n->len; ++i) {
+
+		assert(pow == ((BcBigDig) ((BcDig) pow)));
+
+		if (n->num[i] >= (BcDig) pow) {
+
+			if (i + 1 == n->len) {
+				n->len = bc_vm_growSize(n->len, 1);
+				bc_num_expand(n, n->len);
+				n->num[i + 1] = 0;
+			}
+
+			assert(pow < BC_BASE_POW);
+			n->num[i + 1] += n->num[i] / ((BcDig) pow);
+			n->num[i] %= (BcDig) pow;
+		}
+	}
+
+	return BC_NO_ERR(!s) && BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+}
+
+static BcStatus bc_num_printStack(BcNum *restrict n, BcVec *restrict stack) {
+
+	BcStatus s;
+	BcBigDig dig = 0, acc, base = vm->last_base;
+	size_t i, j, exp = vm->last_exp;
+
+	// This function uses an algorithm that Stefan Esser <se@freebsd.org> came
+	// up with to print the integer part of a number. What it does is convert
+	// intp into a number of the specified base, but it does it directly,
+	// instead of just doing a series of divisions and printing the remainders
+	// in reverse order.
+	//
+	// Let me explain in a bit more detail:
+	//
+	// The algorithm takes the current least significant digit (after intp has
 	// been converted to an integer) and the next to least significant digit,
 	// and it converts the least significant digit into one of the specified
 	// base, putting any overflow into the next to least significant digit. It
@@ -1828,547 +3725,1473 @@ static BcStatus bc_num_printNum(BcNum *restrict n, BcBigDig base,
 	// The conversion happens in bc_num_printPrepare() where the outer loop
 	// happens and bc_num_printFixup() where the inner loop, or actual
 	// conversion, happens.
+	//
+	// The digits are pushed onto stack, least significant first.
+
+	if (vm->last_rem != 0) {
+		s = bc_num_printPrepare(n, vm->last_rem, vm->last_pow);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	}
+
+	for (i = 0; BC_NO_SIG && i < n->len; ++i) {
+
+		acc = (BcBigDig) n->num[i];
+
+		for (j = 0; BC_NO_SIG && j < exp && (i < n->len - 1 || acc != 0); ++j)
+		{
+			if (j != exp - 1) {
+				dig = acc % base;
+				acc /= base;
+			}
+			else {
+				dig = acc;
+				acc = 0;
+			}
+
+			assert(dig < base);
+
+			bc_vec_push(stack, &dig);
+		}
+
+		assert(acc == 0 || BC_SIG);
+	}
+
+	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+}
+
+static BcStatus bc_num_printPows(BcVec *restrict pows, const BcNum *restrict n,
+                                 size_t *restrict digs)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum pow, *last;
+
+	// pows holds obase^digs, and then each power is the square of the one
+	// before. The first one has about half of BC_NUM_PRINT_LEN BcDig's, and
+	// there are enough of them that n is less than the square of the last.
+	if (!pows->len) {
+
+		bc_num_init(&pow, BC_NUM_BIGDIG_LOG10);
+		bc_num_bigdig2num(&pow, vm->last_pow);
+		*digs = vm->last_exp;
+
+		while (BC_NO_ERR(!s) && pow.len < BC_NUM_PRINT_LEN / 2) {
+			s = bc_num_mul(&pow, &pow, &pow, 0);
+			*digs *= 2;
+		}
+
+		if (BC_ERROR_SIGNAL_ONLY(s)) {
+			bc_num_free(&pow);
+			return s;
+		}
+
+		bc_vec_push(pows, &pow);
+	}
+
+	last = bc_vec_top(pows);
+
+	while (bc_vm_arraySize(2, last->len) - 1 <= n->len) {
+
+		bc_num_init(&pow, bc_vm_arraySize(2, last->len));
+
+		s = bc_num_mul(last, last, &pow, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) {
+			bc_num_free(&pow);
+			return s;
+		}
+
+		bc_vec_push(pows, &pow);
+		last = bc_vec_top(pows);
+	}
+
+	return s;
+}
+
+static BcStatus bc_num_printTask(void *data) {
+	BcNumPrintTask *t = (BcNumPrintTask*) data;
+	return bc_num_printDC(t->n, t->pows, t->idx, t->digs, t->pad, &t->stack);
+}
+
+static BcStatus bc_num_printHalves(BcNum *q, BcNum *r,
+                                   const BcVec *restrict pows, size_t idx,
+                                   size_t digs, size_t plen, size_t pad,
+                                   BcVec *restrict stack)
+{
+	BcStatus s;
+	BcNumPrintTask halves[2];
+	size_t i;
+
+	// The two halves are converted into their own stacks on separate threads,
+	// and then the stacks are put on the end of stack in the same order that
+	// bc_num_printDC() would have pushed them. The digits are still printed in
+	// order, by one thread, so the line length is honored like it always is.
+	halves[0].n = r;
+	halves[0].pad = plen;
+	halves[1].n = q;
+	halves[1].pad = pad ? pad - plen : 0;
+
+	for (i = 0; i < 2; ++i) {
+		halves[i].pows = pows;
+		halves[i].idx = idx;
+		halves[i].digs = digs;
+		bc_vec_init(&halves[i].stack, sizeof(BcBigDig), NULL);
+	}
+
+	s = bc_num_tasks(bc_num_printTask, halves, sizeof(BcNumPrintTask), 2, true);
+
+	for (i = 0; i < 2; ++i) {
+		if (BC_NO_ERR(!s))
+			bc_vec_npush(stack, halves[i].stack.len, halves[i].stack.v);
+		bc_vec_free(&halves[i].stack);
+	}
+
+	return s;
+}
+
+static BcStatus bc_num_printDC(BcNum *restrict n, const BcVec *restrict pows,
+                               size_t idx, size_t digs, size_t pad,
+                               BcVec *restrict stack)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum q, r, *pow;
+	BcBigDig zero = 0;
+	size_t plen, start = stack->len;
+	ssize_t cmp;
+
+	assert(!n->rdx && !n->neg);
+
+	// This is here because the function is recursive.
+	if (BC_SIG) return BC_STATUS_SIGNAL;
+
+	// This converts n by dividing it by the biggest power of obase that is not
+	// bigger than it. The remainder gets exactly as many digits as the exponent
+	// of the power, counting leading zeroes, and the quotient is converted
+	// after it because the stack is in reverse. n is less than the square of
+	// pows[idx - 1], so the quotient and the remainder are less than
+	// pows[idx - 1], which is the square of the next power. Small numbers are
+	// converted with bc_num_printStack(). If pad is not zero, it is the number
+	// of digits that n must have.
+	while (idx) {
+
+		pow = bc_vec_item(pows, idx - 1);
+		cmp = bc_num_cmp(n, pow);
+
+#if BC_ENABLE_SIGNALS
+		if (BC_NUM_CMP_SIGNAL(cmp)) return BC_STATUS_SIGNAL;
+#endif // BC_ENABLE_SIGNALS
+
+		if (cmp >= 0) break;
+
+		idx -= 1;
+	}
+
+	if (!idx) {
+		s = bc_num_printStack(n, stack);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	}
+	else {
+
+		plen = digs << (idx - 1);
+
+		assert(!pad || pad > plen);
+
+		bc_num_init(&q, n->len);
+		bc_num_init(&r, pow->len);
+
+		s = bc_num_divmod(n, pow, &q, &r, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+		if (bc_num_threaded(n->len)) {
+			s = bc_num_printHalves(&q, &r, pows, idx - 1, digs, plen, pad,
+			                       stack);
+			goto err;
+		}
+
+		s = bc_num_printDC(&r, pows, idx - 1, digs, plen, stack);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+		s = bc_num_printDC(&q, pows, idx - 1, digs, pad ? pad - plen : 0,
+		                   stack);
+
+err:
+		bc_num_free(&r);
+		bc_num_free(&q);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	}
+
+	while (stack->len - start < pad) bc_vec_push(stack, &zero);
+
+	return s;
+}
+
+static BcStatus bc_num_printFracPow(size_t scale, BcNum *restrict pow,
+                                    size_t *restrict digs)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcVec sqrs;
+	BcNum sqr, temp, *ptr;
+	size_t i, d = 0;
+
+	// This finds the smallest d such that obase^d has more than scale decimal
+	// digits, which is how many digits the fraction is printed with. It starts
+	// with the squares obase^(2^i) and puts together the biggest power that is
+	// too small, one square at a time, from the biggest square.
+	bc_vec_init(&sqrs, sizeof(BcNum), bc_num_free);
+	bc_num_init(&temp, BC_NUM_DEF_SIZE);
+
+	bc_num_init(&sqr, BC_NUM_BIGDIG_LOG10);
+	bc_num_bigdig2num(&sqr, vm->last_base);
+	bc_vec_push(&sqrs, &sqr);
+
+	for (ptr = bc_vec_top(&sqrs); bc_num_intDigits(ptr) <= scale;
+	     ptr = bc_vec_top(&sqrs))
+	{
+		bc_num_init(&sqr, bc_vm_arraySize(2, ptr->len));
+
+		s = bc_num_mul(ptr, ptr, &sqr, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) {
+			bc_num_free(&sqr);
+			goto err;
+		}
+
+		bc_vec_push(&sqrs, &sqr);
+	}
+
+	bc_num_one(pow);
+
+	for (i = sqrs.len - 1; i < sqrs.len; --i) {
+
+		s = bc_num_mul(pow, bc_vec_item(&sqrs, i), &temp, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+		if (bc_num_intDigits(&temp) <= scale) {
+			bc_num_copy(pow, &temp);
+			d += ((size_t) 1) << i;
+		}
+	}
+
+	s = bc_num_mul(pow, bc_vec_item(&sqrs, 0), &temp, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	bc_num_copy(pow, &temp);
+	*digs = d + 1;
+
+err:
+	bc_num_free(&temp);
+	bc_vec_free(&sqrs);
+	return s;
+}
+
+static BcStatus bc_num_printFrac(BcNum *restrict n, BcVec *restrict pows,
+                                 size_t *restrict digs, BcVec *restrict stack,
+                                 size_t len, BcNumDigitOp print)
+{
+	BcStatus s;
+	BcNum pow, f;
+	BcBigDig *ptr;
+	size_t i, d = 0;
+
+	// The fraction digits that bc_num_printNum() prints one at a time are the
+	// digits of the fraction times obase^d, where d is how many there are. So
+	// the fraction is multiplied by obase^d and truncated, and the result is
+	// converted like the integer part, with leading zeroes.
+	bc_num_init(&pow, BC_NUM_DEF_SIZE);
+	bc_num_init(&f, BC_NUM_DEF_SIZE);
+
+	s = bc_num_printFracPow(n->scale, &pow, &d);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	s = bc_num_mul(n, &pow, &f, n->scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	bc_num_truncate(&f, f.scale);
+	f.neg = false;
+
+	bc_vec_npop(stack, stack->len);
+
+	if (vm->last_rem != 0) {
+		s = bc_num_printPows(pows, &f, digs);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_printDC(&f, pows, pows->len, *digs, d, stack);
+	}
+	else s = bc_num_printDC(&f, pows, 0, 0, d, stack);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	for (i = 0; BC_NO_SIG && i < stack->len; ++i) {
+		ptr = bc_vec_item_rev(stack, i);
+		assert(ptr != NULL);
+		print(*ptr, len, !i);
+	}
+
+	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+
+err:
+	bc_num_free(&f);
+	bc_num_free(&pow);
+	return s;
+}
+
+static BcStatus bc_num_printNum(BcNum *restrict n, BcBigDig base,
+                                size_t len, BcNumDigitOp print)
+{
+	BcStatus s;
+	BcVec stack, pows;
+	BcNum intp, fracp1, fracp2, digit, flen1, flen2, *n1, *n2, *temp;
+	BcBigDig dig = 0, *ptr;
+	size_t i, mark, digs = 0;
+	bool radix;
+	BcDig digit_digs[BC_NUM_BIGDIG_LOG10 + 1];
+
+	assert(base > 1);
+
+	if (BC_NUM_ZERO(n)) {
+		print(0, len, false);
+		return BC_STATUS_SUCCESS;
+	}
+
+	bc_vec_init(&stack, sizeof(BcBigDig), NULL);
+	bc_vec_init(&pows, sizeof(BcNum), bc_num_free);
+
+	mark = vm->arena_len;
+
+	bc_num_initTemp(&fracp1, n->rdx);
+	bc_num_initTemp(&intp, n->len);
+	bc_num_copy(&intp, n);
+	bc_num_truncate(&intp, intp.scale);
+
+	s = bc_num_sub(n, &intp, &fracp1, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	if (base != vm->last_base) {
+
+		vm->last_pow = 1;
+		vm->last_exp = 0;
+
+		while (vm->last_pow * base <= BC_BASE_POW) {
+			vm->last_pow *= base;
+			vm->last_exp += 1;
+		}
+
+		vm->last_rem = BC_BASE_POW - vm->last_pow;
+		vm->last_base = base;
+	}
+
+	// Big numbers are converted with divide and conquer, which is much faster
+	// than bc_num_printStack() once the fast multiplication and division
+	// algorithms kick in. When obase^N is BC_BASE_POW, bc_num_printStack() is
+	// linear, so it is used no matter what.
+	if (vm->last_rem != 0 && intp.len >= BC_NUM_PRINT_LEN) {
+
+		intp.neg = false;
+
+		s = bc_num_printPows(&pows, &intp, &digs);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+		s = bc_num_printDC(&intp, &pows, pows.len, digs, 0, &stack);
+	}
+	else s = bc_num_printStack(&intp, &stack);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	for (i = 0; BC_NO_SIG && i < stack.len; ++i) {
+		ptr = bc_vec_item_rev(&stack, i);
+		assert(ptr != NULL);
+		print(*ptr, len, false);
+	}
+
+	if (BC_SIG) goto sig_err;
+	if (!n->scale) goto err;
+
+	if (n->rdx >= BC_NUM_PRINT_LEN) {
+		s = bc_num_printFrac(&fracp1, &pows, &digs, &stack, len, print);
+		goto err;
+	}
+
+	bc_num_initTemp(&fracp2, bc_vm_growSize(n->rdx, 1));
+	bc_num_setup(&digit, digit_digs, sizeof(digit_digs) / sizeof(BcDig));
+	bc_num_initTemp(&flen1, BC_NUM_BIGDIG_LOG10 + 1);
+	bc_num_initTemp(&flen2, BC_NUM_BIGDIG_LOG10 + 1);
+	bc_num_one(&flen1);
+
+	radix = true;
+	n1 = &flen1;
+	n2 = &flen2;
+
+	fracp2.scale = n->scale;
+	fracp2.rdx = BC_NUM_RDX(fracp2.scale);
+
+	while (BC_NO_SIG && bc_num_intDigits(n1) < n->scale + 1) {
+
+		bc_num_expand(&fracp2, fracp1.len + 1);
+		s = bc_num_mulArray(&fracp1, base, &fracp2);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto frac_err;
+		if (fracp2.len < fracp2.rdx) fracp2.len = fracp2.rdx;
+
+		// Will never fail (except for signals) because fracp is
+		// guaranteed to be non-negative and small enough.
+		s = bc_num_bigdig(&fracp2, &dig);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto frac_err;
+
+		bc_num_bigdig2num(&digit, dig);
+		s = bc_num_sub(&fracp2, &digit, &fracp1, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto frac_err;
+
+		print(dig, len, radix);
+		s = bc_num_mulArray(n1, base, n2);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto frac_err;
+
+		radix = false;
+		temp = n1;
+		n1 = n2;
+		n2 = temp;
+	}
+
+frac_err:
+	bc_num_free(&flen2);
+	bc_num_free(&flen1);
+	bc_num_free(&fracp2);
+sig_err:
+	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+err:
+	bc_num_free(&fracp1);
+	bc_num_free(&intp);
+	bc_vm_arenaRelease(mark);
+	bc_vec_free(&pows);
+	bc_vec_free(&stack);
+	return s;
+}
+
+static BcStatus bc_num_printBase(BcNum *restrict n, BcBigDig base) {
+
+	BcStatus s;
+	size_t width;
+	BcNumDigitOp print;
+	bool neg = n->neg;
+
+	if (neg) bc_num_putchar('-');
+
+	n->neg = false;
+
+	if (base <= BC_NUM_MAX_POSIX_IBASE) {
+		width = 1;
+		print = bc_num_printHex;
+	}
+	else {
+		width = bc_num_log10(base - 1);
+		print = bc_num_printDigits;
+	}
+
+	s = bc_num_printNum(n, base, width, print);
+	n->neg = neg;
+
+	return s;
+}
+
+#if DC_ENABLED
+BcStatus bc_num_stream(BcNum *restrict n, BcBigDig base) {
+	return bc_num_printNum(n, base, 1, bc_num_printChar);
+}
+#endif // DC_ENABLED
+
+void bc_num_setup(BcNum *restrict n, BcDig *restrict num, size_t cap) {
+	assert(n != NULL);
+	n->num = num;
+	n->cap = cap;
+	n->inl = n->tmp = false;
+	bc_num_zero(n);
+}
+
+void bc_num_init(BcNum *restrict n, size_t req) {
+
+	assert(n != NULL);
+
+	if (req > BC_NUM_INLINE_SIZE) {
+		size_t size = BC_NUM_SIZE(req);
+		BcDig *num = bc_vm_poolAlloc(&size);
+		bc_num_setup(n, num, size / sizeof(BcDig));
+	}
+	else {
+		n->num = n->digs;
+		n->cap = BC_NUM_INLINE_SIZE;
+		n->inl = true;
+		n->tmp = false;
+		bc_num_zero(n);
+	}
+}
+
+void bc_num_free(void *num) {
+	BcNum *n = (BcNum*) num;
+	assert(n != NULL && BC_NUM_INL_OK(n));
+	if (!n->inl && !n->tmp) bc_vm_poolFree(n->num, BC_NUM_SIZE(n->cap));
+}
+
+void bc_num_copy(BcNum *d, const BcNum *s) {
+	assert(d != NULL && s != NULL && BC_NUM_INL_OK(s));
+	if (d == s) return;
+	bc_num_expand(d, s->len);
+	d->len = s->len;
+	d->neg = s->neg;
+	d->rdx = s->rdx;
+	d->scale = s->scale;
+	memcpy(d->num, s->num, BC_NUM_SIZE(d->len));
+}
+
+void bc_num_createCopy(BcNum *d, const BcNum *s) {
+	bc_num_init(d, s->len);
+	bc_num_copy(d, s);
+}
+
+void bc_num_move(BcNum *restrict d, const BcNum *restrict s) {
+	assert(d != NULL && s != NULL && BC_NUM_INL_OK(s));
+	memcpy(d, s, sizeof(BcNum));
+	BC_NUM_MOVED(d);
+}
+
+void bc_num_swap(BcNum *restrict a, BcNum *restrict b) {
+	BcNum temp;
+	bc_num_move(&temp, a);
+	bc_num_move(a, b);
+	bc_num_move(b, &temp);
+}
+
+void bc_num_createFromBigdig(BcNum *n, BcBigDig val) {
+	bc_num_init(n, (BC_NUM_BIGDIG_LOG10 - 1) / BC_BASE_DIGS + 1);
+	bc_num_bigdig2num(n, val);
+}
+
+size_t bc_num_scale(const BcNum *restrict n) {
+	return n->scale;
+}
+
+size_t bc_num_len(const BcNum *restrict n) {
+
+	size_t len = n->len;
+
+	if (BC_NUM_ZERO(n)) return 0;
+
+	if (n->rdx == len) {
+
+		size_t zero, scale;
+
+		len = bc_num_nonzeroLen(n);
+
+		scale = n->scale % BC_BASE_DIGS;
+		scale = scale ? scale : BC_BASE_DIGS;
+
+		zero = bc_num_zeroDigits(n->num + len - 1);
+
+		len = len * BC_BASE_DIGS - zero - (BC_BASE_DIGS - scale);
+	}
+	else len = bc_num_intDigits(n) + n->scale;
+
+	return len;
+}
+
+BcStatus bc_num_parse(BcNum *restrict n, const char *restrict val,
+                      BcBigDig base, bool letter)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+
+	assert(n != NULL && val != NULL && base);
+	assert(base >= BC_NUM_MIN_BASE && base <= vm->maxes[BC_PROG_GLOBALS_IBASE]);
+	assert(bc_num_strValid(val));
+
+	// Constants are parsed again into the same BcNum when ibase changes, but
+	// the parsing functions need to start from zero.
+	bc_num_zero(n);
+
+	if (letter) {
+		BcBigDig dig = bc_num_parseChar(val[0], BC_NUM_MAX_LBASE);
+		bc_num_bigdig2num(n, dig);
+	}
+	else if (base == BC_BASE) bc_num_parseDecimal(n, val);
+	else s = bc_num_parseBase(n, val, base);
+
+	return s;
+}
+
+BcStatus bc_num_print(BcNum *restrict n, BcBigDig base, bool newline) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+
+	assert(n != NULL);
+	assert(BC_ENABLE_EXTRA_MATH || base >= BC_NUM_MIN_BASE);
+
+	bc_num_printNewline();
+
+	if (BC_NUM_ZERO(n)) bc_num_printHex(0, 1, false);
+	else if (base == BC_BASE) bc_num_printDecimal(n);
+#if BC_ENABLE_EXTRA_MATH
+	else if (base == 0 || base == 1)
+		s = bc_num_printExponent(n, base != 0);
+#endif // BC_ENABLE_EXTRA_MATH
+	else s = bc_num_printBase(n, base);
+
+	if (BC_NO_ERR(!s) && newline) bc_num_putchar('\n');
+
+	return s;
+}
+
+BcStatus bc_num_bigdig(const BcNum *restrict n, BcBigDig *result) {
+
+	size_t i;
+	BcBigDig r;
+
+	assert(n != NULL && result != NULL);
+
+	if (BC_ERR(n->neg)) return bc_vm_err(BC_ERROR_MATH_NEGATIVE);
+
+	for (r = 0, i = n->len; i > n->rdx;) {
+
+		BcBigDig prev = r * BC_BASE_POW;
+
+		if (BC_ERR(prev / BC_BASE_POW != r))
+			return bc_vm_err(BC_ERROR_MATH_OVERFLOW);
+
+		r = prev + (BcBigDig) n->num[--i];
+
+		if (BC_ERR(r < prev)) return bc_vm_err(BC_ERROR_MATH_OVERFLOW);
+	}
+
+	*result = r;
+
+	return BC_STATUS_SUCCESS;
+}
+
+void bc_num_bigdig2num(BcNum *restrict n, BcBigDig val) {
+
+	BcDig *ptr;
+	size_t i;
+
+	assert(n != NULL);
+
+	bc_num_zero(n);
+
+	if (!val) return;
+
+	bc_num_expand(n, BC_NUM_BIGDIG_LOG10);
+
+	for (ptr = n->num, i = 0; val; ++i, val /= BC_BASE_POW)
+		ptr[i] = val % BC_BASE_POW;
+
+	n->len = i;
+}
+
+size_t bc_num_addReq(const BcNum *a, const BcNum *b, size_t scale) {
+
+	size_t aint, bint, ardx, brdx;
+
+	BC_UNUSED(scale);
+
+	ardx = a->rdx;
+	aint = bc_num_int(a);
+	assert(aint <= a->len && ardx <= a->len);
+
+	brdx = b->rdx;
+	bint = bc_num_int(b);
+	assert(bint <= b->len && brdx <= b->len);
+
+	ardx = BC_MAX(ardx, brdx);
+	aint = BC_MAX(aint, bint);
+
+	return bc_vm_growSize(bc_vm_growSize(ardx, aint), 1);
+}
+
+size_t bc_num_mulReq(const BcNum *a, const BcNum *b, size_t scale) {
+	size_t max, rdx;
+	rdx = bc_vm_growSize(a->rdx, b->rdx);
+	max = BC_NUM_RDX(scale);
+	max = bc_vm_growSize(BC_MAX(max, rdx), 1);
+	rdx = bc_vm_growSize(bc_vm_growSize(bc_num_int(a), bc_num_int(b)), max);
+	return rdx;
+}
+
+size_t bc_num_powReq(const BcNum *a, const BcNum *b, size_t scale) {
+	BC_UNUSED(scale);
+	return bc_vm_growSize(bc_vm_growSize(a->len, b->len), 1);
+}
+
+#if BC_ENABLE_EXTRA_MATH
+size_t bc_num_placesReq(const BcNum *a, const BcNum *b, size_t scale) {
+	BC_UNUSED(scale);
+	return a->len + b->len - a->rdx - b->rdx;
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
+BcStatus bc_num_add(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	return bc_num_binary(a, b, c, false, bc_num_as, bc_num_addReq(a, b, scale));
+}
+
+BcStatus bc_num_sub(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	return bc_num_binary(a, b, c, true, bc_num_as, bc_num_addReq(a, b, scale));
+}
+
+BcStatus bc_num_mul(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	return bc_num_binary(a, b, c, scale, bc_num_m, bc_num_mulReq(a, b, scale));
+}
+
+BcStatus bc_num_div(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	return bc_num_binary(a, b, c, scale, bc_num_d, bc_num_mulReq(a, b, scale));
+}
+
+BcStatus bc_num_mod(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	size_t req = bc_num_mulReq(a, b, scale);
+	return bc_num_binary(a, b, c, scale, bc_num_rem, req);
+}
+
+BcStatus bc_num_pow(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	return bc_num_binary(a, b, c, scale, bc_num_p, bc_num_powReq(a, b, scale));
+}
+
+#if BC_ENABLE_EXTRA_MATH
+BcStatus bc_num_places(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	size_t req = bc_num_placesReq(a, b, scale);
+	return bc_num_binary(a, b, c, scale, bc_num_place, req);
+}
+
+BcStatus bc_num_lshift(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	size_t req = bc_num_placesReq(a, b, scale);
+	return bc_num_binary(a, b, c, scale, bc_num_left, req);
+}
+
+BcStatus bc_num_rshift(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	size_t req = bc_num_placesReq(a, b, scale);
+	return bc_num_binary(a, b, c, scale, bc_num_right, req);
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
+#if BC_ENABLED
+BcStatus bc_num_gcd(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	size_t req = BC_MAX(a->len, b->len);
+	return bc_num_binary(a, b, c, scale, bc_num_g, req);
+}
+
+BcStatus bc_num_lcm(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
+	size_t req = bc_vm_growSize(a->len, b->len);
+	return bc_num_binary(a, b, c, scale, bc_num_l, req);
+}
+
+// Binary splitting: for terms [i, j), p and q are the products of the ratios'
+// numerators and denominators, and t / q is the sum of the terms, relative to
+// term i - 1. The sum of [i, k) and [k, j) is t1 / q1 + (p1 / q1) * (t2 / q2),
+// which gives p = p1 * p2, q = q1 * q2, and t = t1 * q2 + p1 * t2. The whole
+// series is then one division of big integers, instead of a division at full
+// scale for every term.
+static BcStatus bc_num_splitSum(BcNumTermOp term, const void *data, size_t i,
+                                size_t j, BcNum *p, BcNum *q, BcNum *t, bool needp)
+{
+	BcStatus s;
+	BcNum p2, q2, t2;
+	size_t k;
+
+	if (j - i == 1) {
+
+		s = term(i, data, p, q, t);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+		return bc_num_mul(t, p, t, 0);
+	}
+
+	k = i + (j - i) / 2;
+
+	bc_num_init(&p2, BC_NUM_DEF_SIZE);
+	bc_num_init(&q2, BC_NUM_DEF_SIZE);
+	bc_num_init(&t2, BC_NUM_DEF_SIZE);
+
+	s = bc_num_splitSum(term, data, i, k, p, q, t, true);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_splitSum(term, data, k, j, &p2, &q2, &t2, needp);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	s = bc_num_mul(t, &q2, t, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mul(p, &t2, &t2, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(t, &t2, t, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_mul(q, &q2, q, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	bc_vec_init(&stack, sizeof(BcBigDig), NULL);
-	bc_num_init(&fracp1, n->rdx);
+	if (needp) s = bc_num_mul(p, &p2, p, 0);
 
-	bc_num_createCopy(&intp, n);
-	bc_num_truncate(&intp, intp.scale);
+err:
+	bc_num_free(&t2);
+	bc_num_free(&q2);
+	bc_num_free(&p2);
+	return s;
+}
 
-	s = bc_num_sub(n, &intp, &fracp1, 0);
-	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+BcStatus bc_num_series(BcNumTermOp term, const void *data, size_t len,
+                       BcNum *restrict t, BcNum *restrict q)
+{
+	BcStatus s;
+	BcNum p;
 
-	if (base != vm->last_base) {
+	assert(term != NULL && len && t != NULL && q != NULL);
 
-		vm->last_pow = 1;
-		vm->last_exp = 0;
+	bc_num_init(&p, BC_NUM_DEF_SIZE);
 
-		while (vm->last_pow * base <= BC_BASE_POW) {
-			vm->last_pow *= base;
-			vm->last_exp += 1;
-		}
+	s = bc_num_splitSum(term, data, 0, len, &p, q, t, false);
 
-		vm->last_rem = BC_BASE_POW - vm->last_pow;
-		vm->last_base = base;
-	}
+	bc_num_free(&p);
+
+	return s;
+}
+#endif // BC_ENABLED
 
-	exp = vm->last_exp;
+static BcBigDig bc_num_sqrtSeed(BcBigDig n) {
 
-	if (vm->last_rem != 0) {
-		s = bc_num_printPrepare(&intp, vm->last_rem, vm->last_pow);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	BcBigDig x = n, y = (n + 1) / 2;
+
+	while (y < x) {
+		x = y;
+		y = (x + n / x) / 2;
 	}
 
-	for (i = 0; BC_NO_SIG && i < intp.len; ++i) {
+	return x;
+}
 
-		acc = (BcBigDig) intp.num[i];
+static BcStatus bc_num_sqrtSmall(BcNum *restrict n, BcNum *restrict x) {
 
-		for (j = 0; BC_NO_SIG && j < exp && (i < intp.len - 1 || acc != 0); ++j)
-		{
-			if (j != exp - 1) {
-				dig = acc % base;
-				acc /= base;
-			}
-			else {
-				dig = acc;
-				acc = 0;
-			}
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum q, y;
+	BcBigDig val, rem;
+	size_t half;
+
+	assert(n->len && n->len <= 5 && !n->rdx);
+
+	// The seed is the square root of the top limb or two, rounded up, so it is
+	// never less than the real square root, and it is never off by more than a
+	// factor of two.
+	half = (n->len - 1) / 2;
+	val = (BcBigDig) n->num[n->len - 1];
+	if (n->len - 2 * half == 2)
+		val = val * BC_BASE_POW + (BcBigDig) n->num[2 * half];
+
+	bc_num_bigdig2num(x, bc_num_sqrtSeed(val) + 1);
+	s = bc_num_shiftLeft(x, half * BC_BASE_DIGS);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-			assert(dig < base);
+	bc_num_init(&q, n->len);
+	bc_num_init(&y, n->len);
 
-			bc_vec_push(&stack, &dig);
-		}
+	// Newton's method from above decreases until it hits the integer square
+	// root, and then it stops decreasing.
+	while (BC_NO_SIG) {
 
-		assert(acc == 0 || BC_SIG);
-	}
+		s = bc_num_div(n, x, &q, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(x, &q, &y, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	if (BC_SIG) goto sig_err;
+		bc_num_expand(&q, y.len);
+		s = bc_num_divArray(&y, 2, &q, &rem);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	for (i = 0; BC_NO_SIG && i < stack.len; ++i) {
-		ptr = bc_vec_item_rev(&stack, i);
-		assert(ptr != NULL);
-		print(*ptr, len, false);
+		if (bc_num_cmp(&q, x) >= 0) break;
+
+		bc_num_swap(x, &q);
 	}
 
-	if (BC_SIG) goto sig_err;
-	if (!n->scale) goto err;
+	if (BC_SIG) s = BC_STATUS_SIGNAL;
 
-	bc_num_init(&fracp2, n->rdx);
-	bc_num_setup(&digit, digit_digs, sizeof(digit_digs) / sizeof(BcDig));
-	bc_num_init(&flen1, BC_NUM_BIGDIG_LOG10 + 1);
-	bc_num_init(&flen2, BC_NUM_BIGDIG_LOG10 + 1);
-	bc_num_one(&flen1);
+err:
+	bc_num_free(&y);
+	bc_num_free(&q);
+	return s;
+}
 
-	radix = true;
-	n1 = &flen1;
-	n2 = &flen2;
+static BcStatus bc_num_sqrtNewton(BcNum *restrict n, BcNum *restrict x) {
 
-	fracp2.scale = n->scale;
-	fracp2.rdx = BC_NUM_RDX(fracp2.scale);
+	BcStatus s;
+	BcNum hi, lo, q, y;
+	BcBigDig rem;
+	size_t k, mark;
 
-	while (BC_NO_SIG && bc_num_intDigits(n1) < n->scale + 1) {
+	// This is here because the function is recursive.
+	if (BC_SIG) return BC_STATUS_SIGNAL;
 
-		bc_num_expand(&fracp2, fracp1.len + 1);
-		s = bc_num_mulArray(&fracp1, base, &fracp2);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto frac_err;
-		if (fracp2.len < fracp2.rdx) fracp2.len = fracp2.rdx;
+	if (n->len <= 5) return bc_num_sqrtSmall(n, x);
 
-		// Will never fail (except for signals) because fracp is
-		// guaranteed to be non-negative and small enough.
-		s = bc_num_bigdig(&fracp2, &dig);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto frac_err;
+	// The square root of the top half of n, shifted, is right in about half of
+	// its digits, so one Newton step from there doubles the precision, and it
+	// lands just above the integer square root. The top half keeps one limb
+	// more than half so that it stays within one or two even when the top limb
+	// of n is small.
+	k = (n->len - 2) / 4;
+	bc_num_toomPiece(n, 2 * k, n->len, &hi);
+	bc_num_toomPiece(n, k, n->len, &lo);
 
-		bc_num_bigdig2num(&digit, dig);
-		s = bc_num_sub(&fracp2, &digit, &fracp1, 0);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto frac_err;
+	s = bc_num_sqrtNewton(&hi, x);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-		print(dig, len, radix);
-		s = bc_num_mulArray(n1, base, n2);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto frac_err;
+	mark = vm->arena_len;
 
-		radix = false;
-		temp = n1;
-		n1 = n2;
-		n2 = temp;
-	}
+	bc_num_initTemp(&q, lo.len);
+	bc_num_initTemp(&y, lo.len);
+
+	// The shifted root has k zero limbs, so n can lose them too.
+	s = bc_num_div(&lo, x, &q, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_shiftLeft(x, k * BC_BASE_DIGS);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_add(x, &q, &y, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	bc_num_expand(x, y.len);
+	s = bc_num_divArray(&y, 2, x, &rem);
 
-frac_err:
-	bc_num_free(&flen2);
-	bc_num_free(&flen1);
-	bc_num_free(&fracp2);
-sig_err:
-	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
 err:
-	bc_num_free(&fracp1);
-	bc_num_free(&intp);
-	bc_vec_free(&stack);
+	bc_num_free(&y);
+	bc_num_free(&q);
+	bc_vm_arenaRelease(mark);
 	return s;
 }
 
-static BcStatus bc_num_printBase(BcNum *restrict n, BcBigDig base) {
+static BcStatus bc_num_isqrt(BcNum *restrict n, BcNum *restrict x) {
 
 	BcStatus s;
-	size_t width;
-	BcNumDigitOp print;
-	bool neg = n->neg;
+	BcNum r, sq, one;
+	BcDig one_digs[1];
+	size_t mark;
 
-	if (neg) bc_num_putchar('-');
+	assert(BC_NUM_NONZERO(n) && !n->rdx && !n->neg);
 
-	n->neg = false;
+	s = bc_num_sqrtNewton(n, x);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-	if (base <= BC_NUM_MAX_POSIX_IBASE) {
-		width = 1;
-		print = bc_num_printHex;
-	}
-	else {
-		width = bc_num_log10(base - 1);
-		print = bc_num_printDigits;
+	mark = vm->arena_len;
+
+	bc_num_initTemp(&sq, bc_vm_arraySize(2, x->len));
+	bc_num_initTemp(&r, n->len);
+	bc_num_setup(&one, one_digs, sizeof(one_digs) / sizeof(BcDig));
+	bc_num_one(&one);
+
+	s = bc_num_mul(x, x, &sq, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_sub(n, &sq, &r, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	// The root can only be a little too big, and (x - 1)^2 = x^2 - 2 * x + 1,
+	// so this walks it down without another multiplication.
+	while (BC_NO_SIG && r.neg) {
+
+		s = bc_num_add(&r, x, &r, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_sub(x, &one, x, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		s = bc_num_add(&r, x, &r, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 	}
 
-	s = bc_num_printNum(n, base, width, print);
-	n->neg = neg;
+	if (BC_SIG) s = BC_STATUS_SIGNAL;
 
+err:
+	bc_num_free(&r);
+	bc_num_free(&sq);
+	bc_vm_arenaRelease(mark);
 	return s;
 }
 
-#if DC_ENABLED
-BcStatus bc_num_stream(BcNum *restrict n, BcBigDig base) {
-	return bc_num_printNum(n, base, 1, bc_num_printChar);
-}
-#endif // DC_ENABLED
-
-void bc_num_setup(BcNum *restrict n, BcDig *restrict num, size_t cap) {
-	assert(n != NULL);
-	n->num = num;
-	n->cap = cap;
-	bc_num_zero(n);
-}
+BcStatus bc_num_sqrt(BcNum *restrict a, BcNum *restrict b, size_t scale) {
 
-void bc_num_init(BcNum *restrict n, size_t req) {
-	assert(n != NULL);
-	req = req >= BC_NUM_DEF_SIZE ? req : BC_NUM_DEF_SIZE;
-	bc_num_setup(n, bc_vm_malloc(BC_NUM_SIZE(req)), req);
-}
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum n;
+	size_t len, rdx, req, mark;
 
-void bc_num_free(void *num) {
-	assert(num != NULL);
-	free(((BcNum*) num)->num);
-}
+	assert(a != NULL && b != NULL && a != b);
 
-void bc_num_copy(BcNum *d, const BcNum *s) {
-	assert(d != NULL && s != NULL);
-	if (d == s) return;
-	bc_num_expand(d, s->len);
-	d->len = s->len;
-	d->neg = s->neg;
-	d->rdx = s->rdx;
-	d->scale = s->scale;
-	memcpy(d->num, s->num, BC_NUM_SIZE(d->len));
-}
+	if (BC_ERR(a->neg)) return bc_vm_err(BC_ERROR_MATH_NEGATIVE);
 
-void bc_num_createCopy(BcNum *d, const BcNum *s) {
-	bc_num_init(d, s->len);
-	bc_num_copy(d, s);
-}
+	if (a->scale > scale) scale = a->scale;
+	len = bc_vm_growSize(bc_num_intDigits(a), 1);
+	rdx = BC_NUM_RDX(scale);
+	req = bc_vm_growSize(BC_MAX(rdx, a->rdx), len >> 1);
+	bc_num_init(b, bc_vm_growSize(req, 1));
 
-void bc_num_createFromBigdig(BcNum *n, BcBigDig val) {
-	bc_num_init(n, (BC_NUM_BIGDIG_LOG10 - 1) / BC_BASE_DIGS + 1);
-	bc_num_bigdig2num(n, val);
-}
+	if (BC_NUM_ZERO(a)) {
+		bc_num_setToZero(b, scale);
+		return BC_STATUS_SUCCESS;
+	}
+	if (BC_NUM_ONE(a)) {
+		bc_num_one(b);
+		bc_num_extend(b, scale);
+		return BC_STATUS_SUCCESS;
+	}
 
-size_t bc_num_scale(const BcNum *restrict n) {
-	return n->scale;
-}
+	// The result is the integer square root of a * 10^(2 * scale), shifted back
+	// by scale digits. That is exactly a truncated to scale digits.
+	mark = vm->arena_len;
 
-size_t bc_num_len(const BcNum *restrict n) {
+	len = BC_NUM_RDX(bc_vm_growSize(scale, scale));
+	bc_num_initTemp(&n, bc_vm_growSize(a->len, len));
+	bc_num_copy(&n, a);
 
-	size_t len = n->len;
+	s = bc_num_shiftLeft(&n, bc_vm_growSize(scale, scale));
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_isqrt(&n, b);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_shiftRight(b, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	if (BC_NUM_ZERO(n)) return 0;
+	assert(!b->neg || BC_NUM_NONZERO(b));
+	assert(b->rdx <= b->len || !b->len);
+	assert(!b->len || b->num[b->len - 1] || b->rdx == b->len);
 
-	if (n->rdx == len) {
+err:
+	if (BC_ERR(s)) bc_num_free(b);
+	bc_num_free(&n);
+	bc_vm_arenaRelease(mark);
+	return s;
+}
 
-		size_t zero, scale;
+BcStatus bc_num_divmod(BcNum *a, BcNum *b, BcNum *c, BcNum *d, size_t scale) {
 
-		len = bc_num_nonzeroLen(n);
+	BcStatus s;
+	BcNum num2, *ptr_a;
+	bool init = false;
+	size_t ts, len;
 
-		scale = n->scale % BC_BASE_DIGS;
-		scale = scale ? scale : BC_BASE_DIGS;
+	ts = BC_MAX(scale + b->scale, a->scale);
+	len = bc_num_mulReq(a, b, ts);
 
-		zero = bc_num_zeroDigits(n->num + len - 1);
+	assert(a != NULL && b != NULL && c != NULL && d != NULL);
+	assert(c != d && a != d && b != d && b != c);
 
-		len = len * BC_BASE_DIGS - zero - (BC_BASE_DIGS - scale);
+	if (c == a) {
+		bc_num_move(&num2, c);
+		ptr_a = &num2;
+		bc_num_init(c, len);
+		init = true;
+	}
+	else {
+		ptr_a = a;
+		bc_num_expand(c, len);
 	}
-	else len = bc_num_intDigits(n) + n->scale;
 
-	return len;
-}
+	if (BC_NUM_NONZERO(a) && !a->rdx && !b->rdx && b->len == 1 && !scale) {
 
-BcStatus bc_num_parse(BcNum *restrict n, const char *restrict val,
-                      BcBigDig base, bool letter)
-{
-	BcStatus s = BC_STATUS_SUCCESS;
+		BcBigDig rem;
 
-	assert(n != NULL && val != NULL && base);
-	assert(base >= BC_NUM_MIN_BASE && base <= vm->maxes[BC_PROG_GLOBALS_IBASE]);
-	assert(bc_num_strValid(val));
+		s = bc_num_divArray(ptr_a, (BcBigDig) b->num[0], c, &rem);
 
-	if (letter) {
-		BcBigDig dig = bc_num_parseChar(val[0], BC_NUM_MAX_LBASE);
-		bc_num_bigdig2num(n, dig);
+		assert(rem < BC_BASE_POW);
+
+		d->num[0] = (BcDig) rem;
+		d->len = (rem != 0);
 	}
-	else if (base == BC_BASE) bc_num_parseDecimal(n, val);
-	else s = bc_num_parseBase(n, val, base);
+	else s = bc_num_r(ptr_a, b, c, d, scale, ts);
+
+	assert(!c->neg || BC_NUM_NONZERO(c));
+	assert(c->rdx <= c->len || !c->len);
+	assert(!c->len || c->num[c->len - 1] || c->rdx == c->len);
+	assert(!d->neg || BC_NUM_NONZERO(d));
+	assert(d->rdx <= d->len || !d->len);
+	assert(!d->len || d->num[d->len - 1] || d->rdx == d->len);
+
+	if (init) bc_num_free(&num2);
 
 	return s;
 }
 
-BcStatus bc_num_print(BcNum *restrict n, BcBigDig base, bool newline) {
+#if DC_ENABLED
+static size_t bc_num_binFrom(const BcNum *restrict n, BcBinDig *restrict b,
+                             size_t len)
+{
+	size_t i, j, blen = 0;
+	BcBigDig carry;
 
-	BcStatus s = BC_STATUS_SUCCESS;
+	assert(!n->rdx);
 
-	assert(n != NULL);
-	assert(BC_ENABLE_EXTRA_MATH || base >= BC_NUM_MIN_BASE);
+	// Binary limbs are wider than decimal ones, so n->len of them is always
+	// enough. The decimal limbs are put in from the top, like Horner's method.
+	for (i = n->len; BC_NO_SIG && i--;) {
 
-	bc_num_printNewline();
+		carry = (BcBigDig) n->num[i];
 
-	if (BC_NUM_ZERO(n)) bc_num_printHex(0, 1, false);
-	else if (base == BC_BASE) bc_num_printDecimal(n);
-#if BC_ENABLE_EXTRA_MATH
-	else if (base == 0 || base == 1)
-		s = bc_num_printExponent(n, base != 0);
-#endif // BC_ENABLE_EXTRA_MATH
-	else s = bc_num_printBase(n, base);
+		for (j = 0; j < blen; ++j) {
+			carry += ((BcBigDig) b[j]) * BC_BASE_POW;
+			b[j] = (BcBinDig) (carry & BC_NUM_BIN_MASK);
+			carry >>= BC_NUM_BIN_BITS;
+		}
 
-	if (BC_NO_ERR(!s) && newline) bc_num_putchar('\n');
+		if (carry) {
+			assert(blen < len);
+			b[blen++] = (BcBinDig) carry;
+		}
+	}
 
-	return s;
+	for (j = blen; j < len; ++j) b[j] = 0;
+
+	return blen;
 }
 
-BcStatus bc_num_bigdig(const BcNum *restrict n, BcBigDig *result) {
+static void bc_num_binTo(BcNum *restrict n, const BcBinDig *restrict b,
+                         size_t len)
+{
+	size_t i, j;
+	BcBigDig carry;
 
-	size_t i;
-	BcBigDig r;
+	while (len && !b[len - 1]) --len;
 
-	assert(n != NULL && result != NULL);
+	bc_num_zero(n);
+	bc_num_expand(n, bc_vm_growSize(bc_vm_growSize(len, len), 1));
 
-	if (BC_ERR(n->neg)) return bc_vm_err(BC_ERROR_MATH_NEGATIVE);
+	// This is the only place where the binary limbs pay for the divisions by
+	// BC_BASE_POW that they saved.
+	for (i = len; BC_NO_SIG && i--;) {
 
-	for (r = 0, i = n->len; i > n->rdx;) {
+		carry = (BcBigDig) b[i];
 
-		BcBigDig prev = r * BC_BASE_POW;
+		for (j = 0; j < n->len; ++j) {
+			carry += ((BcBigDig) n->num[j]) << BC_NUM_BIN_BITS;
+			n->num[j] = (BcDig) (carry % BC_BASE_POW);
+			carry /= BC_BASE_POW;
+		}
 
-		if (BC_ERR(prev / BC_BASE_POW != r))
-			return bc_vm_err(BC_ERROR_MATH_OVERFLOW);
+		for (; carry; carry /= BC_BASE_POW)
+			n->num[n->len++] = (BcDig) (carry % BC_BASE_POW);
+	}
+}
 
-		r = prev + (BcBigDig) n->num[--i];
+static void bc_num_binMontMul(BcBinDig *c, const BcBinDig *a,
+                              const BcBinDig *b, const BcBinDig *restrict m,
+                              size_t len, BcBinDig minv, BcBinDig *restrict t)
+{
+	size_t i, j;
+	BcBigDig carry, q, x;
+	bool sub;
 
-		if (BC_ERR(r < prev)) return bc_vm_err(BC_ERROR_MATH_OVERFLOW);
-	}
+	assert(len);
 
-	*result = r;
+	memset(t, 0, (len + 2) * sizeof(BcBinDig));
 
-	return BC_STATUS_SUCCESS;
-}
+	// This is Montgomery multiplication, one limb of b at a time. Adding a
+	// multiple of m that clears the bottom limb of t lets it be shifted out,
+	// so every carry is a shift instead of a division.
+	for (i = 0; i < len; ++i) {
 
-void bc_num_bigdig2num(BcNum *restrict n, BcBigDig val) {
+		for (carry = 0, j = 0; j < len; ++j) {
+			carry += ((BcBigDig) t[j]) + ((BcBigDig) a[j]) * b[i];
+			t[j] = (BcBinDig) (carry & BC_NUM_BIN_MASK);
+			carry >>= BC_NUM_BIN_BITS;
+		}
 
-	BcDig *ptr;
-	size_t i;
+		carry += (BcBigDig) t[len];
+		t[len] = (BcBinDig) (carry & BC_NUM_BIN_MASK);
+		t[len + 1] = (BcBinDig) (carry >> BC_NUM_BIN_BITS);
 
-	assert(n != NULL);
+		q = (((BcBigDig) t[0]) * minv) & BC_NUM_BIN_MASK;
+		carry = (((BcBigDig) t[0]) + q * m[0]) >> BC_NUM_BIN_BITS;
 
-	bc_num_zero(n);
+		for (j = 1; j < len; ++j) {
+			carry += ((BcBigDig) t[j]) + q * m[j];
+			t[j - 1] = (BcBinDig) (carry & BC_NUM_BIN_MASK);
+			carry >>= BC_NUM_BIN_BITS;
+		}
 
-	if (!val) return;
+		carry += (BcBigDig) t[len];
+		t[len - 1] = (BcBinDig) (carry & BC_NUM_BIN_MASK);
+		t[len] = (BcBinDig) (t[len + 1] + (carry >> BC_NUM_BIN_BITS));
+	}
 
-	bc_num_expand(n, BC_NUM_BIGDIG_LOG10);
+	// t is less than 2 * m, so one subtraction is always enough.
+	sub = (t[len] != 0);
 
-	for (ptr = n->num, i = 0; val; ++i, val /= BC_BASE_POW)
-		ptr[i] = val % BC_BASE_POW;
+	if (!sub) {
+		for (i = len - 1; i < len && t[i] == m[i]; --i);
+		sub = (i >= len || t[i] > m[i]);
+	}
 
-	n->len = i;
+	if (sub) {
+		for (carry = 0, i = 0; i < len; ++i) {
+			x = ((BcBigDig) m[i]) + carry;
+			carry = (t[i] < x);
+			c[i] = (BcBinDig) (((BcBigDig) t[i]) +
+			                   (carry << BC_NUM_BIN_BITS) - x);
+		}
+	}
+	else memcpy(c, t, len * sizeof(BcBinDig));
 }
 
-size_t bc_num_addReq(const BcNum *a, const BcNum *b, size_t scale) {
+static BcStatus bc_num_modmul(BcNum *a, BcNum *b, BcNum *c, BcNum *m,
+                              BcNum *mu, BcNum *t, BcNum *q)
+{
+	BcStatus s;
+	BcNum view;
 
-	size_t aint, bint, ardx, brdx;
+	assert(c != t && c != q && t != q);
 
-	BC_UNUSED(scale);
+	// This is Barrett's reduction. a and b are less than m, so their product
+	// has at most 2 * m->len limbs, and the estimate of the quotient, from its
+	// top limbs and mu, is never more than 2 too small.
+	s = bc_num_mul(a, b, t, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-	ardx = a->rdx;
-	aint = bc_num_int(a);
-	assert(aint <= a->len && ardx <= a->len);
+	bc_num_toomPiece(t, m->len - 1, t->len, &view);
+	s = bc_num_mul(&view, mu, q, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-	brdx = b->rdx;
-	bint = bc_num_int(b);
-	assert(bint <= b->len && brdx <= b->len);
+	bc_num_toomPiece(q, m->len + 1, q->len, &view);
+	s = bc_num_mul(&view, m, c, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	s = bc_num_sub(t, c, q, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-	ardx = BC_MAX(ardx, brdx);
-	aint = BC_MAX(aint, bint);
+	while (BC_NO_SIG && bc_num_cmp(q, m) >= 0) {
 
-	return bc_vm_growSize(bc_vm_growSize(ardx, aint), 1);
-}
+		s = bc_num_sub(q, m, t, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
-size_t bc_num_mulReq(const BcNum *a, const BcNum *b, size_t scale) {
-	size_t max, rdx;
-	rdx = bc_vm_growSize(a->rdx, b->rdx);
-	max = BC_NUM_RDX(scale);
-	max = bc_vm_growSize(BC_MAX(max, rdx), 1);
-	rdx = bc_vm_growSize(bc_vm_growSize(bc_num_int(a), bc_num_int(b)), max);
-	return rdx;
-}
+		bc_num_swap(q, t);
+	}
 
-size_t bc_num_powReq(const BcNum *a, const BcNum *b, size_t scale) {
-	BC_UNUSED(scale);
-	return bc_vm_growSize(bc_vm_growSize(a->len, b->len), 1);
-}
+	bc_num_copy(c, q);
 
-#if BC_ENABLE_EXTRA_MATH
-size_t bc_num_placesReq(const BcNum *a, const BcNum *b, size_t scale) {
-	BC_UNUSED(scale);
-	return a->len + b->len - a->rdx - b->rdx;
+	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
 }
-#endif // BC_ENABLE_EXTRA_MATH
 
-BcStatus bc_num_add(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
-	return bc_num_binary(a, b, c, false, bc_num_as, bc_num_addReq(a, b, scale));
-}
+static BcStatus bc_num_modexpBits(const BcNum *restrict n,
+                                  BcVec *restrict bits)
+{
+	BcBinDig *b;
+	size_t i, len;
+	uchar bit;
 
-BcStatus bc_num_sub(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
-	return bc_num_binary(a, b, c, true, bc_num_as, bc_num_addReq(a, b, scale));
-}
+	b = bc_vm_malloc(bc_vm_arraySize(n->len, sizeof(BcBinDig)));
 
-BcStatus bc_num_mul(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
-	return bc_num_binary(a, b, c, scale, bc_num_m, bc_num_mulReq(a, b, scale));
-}
+	// With binary limbs, the bits can just be read off.
+	len = bc_num_binFrom(n, b, n->len);
 
-BcStatus bc_num_div(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
-	return bc_num_binary(a, b, c, scale, bc_num_d, bc_num_mulReq(a, b, scale));
-}
+	for (i = 0; BC_NO_SIG && i < len * BC_NUM_BIN_BITS; ++i) {
+		bit = (uchar) ((b[i / BC_NUM_BIN_BITS] >> (i % BC_NUM_BIN_BITS)) & 1);
+		bc_vec_push(bits, &bit);
+	}
 
-BcStatus bc_num_mod(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
-	size_t req = bc_num_mulReq(a, b, scale);
-	return bc_num_binary(a, b, c, scale, bc_num_rem, req);
-}
+	while (bits->len && !*((uchar*) bc_vec_top(bits))) bc_vec_pop(bits);
 
-BcStatus bc_num_pow(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
-	return bc_num_binary(a, b, c, scale, bc_num_p, bc_num_powReq(a, b, scale));
-}
+	free(b);
 
-#if BC_ENABLE_EXTRA_MATH
-BcStatus bc_num_places(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
-	size_t req = bc_num_placesReq(a, b, scale);
-	return bc_num_binary(a, b, c, scale, bc_num_place, req);
+	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
 }
 
-BcStatus bc_num_lshift(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
-	size_t req = bc_num_placesReq(a, b, scale);
-	return bc_num_binary(a, b, c, scale, bc_num_left, req);
-}
+static void bc_num_modexpWindows(const BcVec *restrict bits, size_t w,
+                                 BcVec *restrict wins)
+{
+	size_t i, j, k, idx, sqrs = 0;
+	uchar *bit;
 
-BcStatus bc_num_rshift(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
-	size_t req = bc_num_placesReq(a, b, scale);
-	return bc_num_binary(a, b, c, scale, bc_num_right, req);
-}
-#endif // BC_ENABLE_EXTRA_MATH
+	// The bits are little endian, and the top one is set. Each window is a
+	// pair of the number of squarings before it and the index of its odd
+	// power, or BC_VEC_INVALID_IDX for the squarings of trailing zero bits.
+	for (i = bits->len; i; i = j) {
 
-BcStatus bc_num_sqrt(BcNum *restrict a, BcNum *restrict b, size_t scale) {
+		bit = bc_vec_item(bits, i - 1);
 
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcNum num1, num2, half, f, fprime, *x0, *x1, *temp;
-	size_t pow, len, rdx, req, digs, digs1, digs2, resscale;
-	BcDig half_digs[1];
+		if (!*bit) {
+			sqrs += 1;
+			j = i - 1;
+			continue;
+		}
 
-	assert(a != NULL && b != NULL && a != b);
+		j = i > w ? i - w : 0;
+		while (!*((uchar*) bc_vec_item(bits, j))) ++j;
 
-	if (BC_ERR(a->neg)) return bc_vm_err(BC_ERROR_MATH_NEGATIVE);
+		for (idx = 0, k = i; k > j; --k) {
+			bit = bc_vec_item(bits, k - 1);
+			idx = (idx << 1) | *bit;
+		}
 
-	if (a->scale > scale) scale = a->scale;
-	len = bc_vm_growSize(bc_num_intDigits(a), 1);
-	rdx = BC_NUM_RDX(scale);
-	req = bc_vm_growSize(BC_MAX(rdx, a->rdx), len >> 1);
-	bc_num_init(b, bc_vm_growSize(req, 1));
+		sqrs += i - j;
+		idx >>= 1;
 
-	if (BC_NUM_ZERO(a)) {
-		bc_num_setToZero(b, scale);
-		return BC_STATUS_SUCCESS;
-	}
-	if (BC_NUM_ONE(a)) {
-		bc_num_one(b);
-		bc_num_extend(b, scale);
-		return BC_STATUS_SUCCESS;
+		bc_vec_push(wins, &sqrs);
+		bc_vec_push(wins, &idx);
+
+		sqrs = 0;
 	}
 
-	rdx = BC_NUM_RDX(scale);
-	rdx = BC_MAX(rdx, a->rdx);
-	len = bc_vm_growSize(a->len, rdx);
+	if (sqrs) {
+		idx = BC_VEC_INVALID_IDX;
+		bc_vec_push(wins, &sqrs);
+		bc_vec_push(wins, &idx);
+	}
+}
 
-	bc_num_init(&num1, len);
-	bc_num_init(&num2, len);
-	bc_num_setup(&half, half_digs, sizeof(half_digs) / sizeof(BcDig));
+static BcStatus bc_num_modexpBarrett(BcNum *restrict base, BcNum *restrict m,
+                                     const BcVec *restrict wins, size_t w,
+                                     BcNum *restrict d)
+{
+	BcStatus s;
+	BcNum mu, t, q, pow;
+	BcVec pows;
+	size_t i, k, len, sqrs, idx;
+
+	len = bc_vm_growSize(m->len, m->len);
+
+	bc_num_init(&mu, bc_vm_growSize(m->len, 2));
+	bc_num_init(&t, bc_vm_growSize(len, 1));
+	bc_num_init(&q, bc_vm_growSize(len, 2));
+	bc_vec_init(&pows, sizeof(BcNum), bc_num_free);
+
+	// This is the only division. mu is BC_BASE_POW^(2 * m->len) / m.
+	memset(t.num, 0, BC_NUM_SIZE(len));
+	t.num[len] = 1;
+	t.len = len + 1;
+	s = bc_num_div(&t, m, &mu, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	bc_num_one(&half);
-	half.num[0] = BC_BASE_POW / 2;
-	half.len = 1;
-	half.rdx = 1;
-	half.scale = 1;
+	bc_num_createCopy(&pow, base);
+	bc_vec_push(&pows, &pow);
 
-	bc_num_init(&f, len);
-	bc_num_init(&fprime, len);
+	if (w > 1) {
 
-	x0 = &num1;
-	x1 = &num2;
+		BcNum sqr;
 
-	bc_num_one(x0);
-	pow = bc_num_intDigits(a);
+		bc_num_init(&sqr, m->len);
 
-	if (pow) {
+		s = bc_num_modmul(base, base, &sqr, m, &mu, &t, &q);
 
-		if (pow & 1) x0->num[0] = 2;
-		else x0->num[0] = 6;
+		for (i = 1; BC_NO_ERR(!s) && i < ((size_t) 1) << (w - 1); ++i) {
+			bc_num_init(&pow, m->len);
+			s = bc_num_modmul(bc_vec_item(&pows, i - 1), &sqr, &pow, m, &mu,
+			                  &t, &q);
+			bc_vec_push(&pows, &pow);
+		}
 
-		pow -= 2 - (pow & 1);
-		s = bc_num_shiftLeft(x0, pow / 2);
+		bc_num_free(&sqr);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 	}
 
-	x0->scale = x0->rdx = digs = digs1 = digs2 = 0;
-	resscale = (scale + BC_BASE_DIGS) + 2;
-
-	while (BC_NO_SIG && bc_num_cmp(x1, x0)) {
+	for (i = 0; BC_NO_SIG && i < wins->len; i += 2) {
 
-		assert(BC_NUM_NONZERO(x0));
+		sqrs = *((size_t*) bc_vec_item(wins, i));
+		idx = *((size_t*) bc_vec_item(wins, i + 1));
 
-		s = bc_num_div(a, x0, &f, resscale);
-		assert(!s || s == BC_STATUS_SIGNAL);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-		s = bc_num_add(x0, &f, &fprime, resscale);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-		s = bc_num_mul(&fprime, &half, x1, resscale);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		// d is still 1, so the first window just copies its power.
+		if (!i) {
+			bc_num_copy(d, bc_vec_item(&pows, idx));
+			continue;
+		}
 
-		temp = x0;
-		x0 = x1;
-		x1 = temp;
-	}
+		for (k = 0; k < sqrs; ++k) {
+			s = bc_num_modmul(d, d, d, m, &mu, &t, &q);
+			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		}
 
-	if (BC_SIG) {
-		s = BC_STATUS_SIGNAL;
-		goto err;
+		if (idx != BC_VEC_INVALID_IDX) {
+			s = bc_num_modmul(d, bc_vec_item(&pows, idx), d, m, &mu, &t, &q);
+			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		}
 	}
 
-	bc_num_copy(b, x0);
-	if (b->scale > scale) bc_num_truncate(b, b->scale - scale);
-
-	assert(!b->neg || BC_NUM_NONZERO(b));
-	assert(b->rdx <= b->len || !b->len);
-	assert(!b->len || b->num[b->len - 1] || b->rdx == b->len);
+	if (BC_SIG) s = BC_STATUS_SIGNAL;
 
 err:
-	if (BC_ERR(s)) bc_num_free(b);
-	bc_num_free(&fprime);
-	bc_num_free(&f);
-	bc_num_free(&num2);
-	bc_num_free(&num1);
+	bc_vec_free(&pows);
+	bc_num_free(&q);
+	bc_num_free(&t);
+	bc_num_free(&mu);
 	return s;
 }
 
-BcStatus bc_num_divmod(BcNum *a, BcNum *b, BcNum *c, BcNum *d, size_t scale) {
-
+static BcStatus bc_num_modexpMont(BcNum *restrict base, BcNum *restrict m,
+                                  const BcVec *restrict wins, size_t w,
+                                  BcNum *restrict d)
+{
 	BcStatus s;
-	BcNum num2, *ptr_a;
-	bool init = false;
-	size_t ts, len;
+	BcNum r, t;
+	BcBinDig *mb, *pows, *x, *tb, minv;
+	BcBigDig inv;
+	size_t i, k, len, sqrs, idx, npows = ((size_t) 1) << (w - 1);
 
-	ts = BC_MAX(scale + b->scale, a->scale);
-	len = bc_num_mulReq(a, b, ts);
+	assert(m->num[0] & 1);
 
-	assert(a != NULL && b != NULL && c != NULL && d != NULL);
-	assert(c != d && a != d && b != d && b != c);
+	mb = bc_vm_malloc(bc_vm_arraySize(m->len, sizeof(BcBinDig)));
+	len = bc_num_binFrom(m, mb, m->len);
 
-	if (c == a) {
-		memcpy(&num2, c, sizeof(BcNum));
-		ptr_a = &num2;
-		bc_num_init(c, len);
-		init = true;
-	}
-	else {
-		ptr_a = a;
-		bc_num_expand(c, len);
+	// The powers, the result, and the scratch space for bc_num_binMontMul().
+	k = bc_vm_growSize(bc_vm_arraySize(npows + 1, len), len + 2);
+	pows = bc_vm_malloc(bc_vm_arraySize(k, sizeof(BcBinDig)));
+	x = pows + npows * len;
+	tb = x + len;
+
+	// minv is -1/m mod 2^BC_NUM_BIN_BITS. An odd number is its own inverse to
+	// 3 bits, and every step of Newton's method doubles that.
+	for (inv = mb[0], i = 3; i < BC_NUM_BIN_BITS; i *= 2)
+		inv = (inv * (2 - mb[0] * inv)) & BC_NUM_BIN_MASK;
+
+	minv = (BcBinDig) ((0 - inv) & BC_NUM_BIN_MASK);
+
+	bc_num_init(&r, bc_vm_growSize(bc_vm_growSize(len, len), 2));
+	bc_num_init(&t, bc_vm_growSize(r.cap, m->len));
+
+	// base * R mod m, where R is 2^(BC_NUM_BIN_BITS * len), is the Montgomery
+	// form of base. That, and the conversions, are the only decimal work.
+	memset(tb, 0, len * sizeof(BcBinDig));
+	tb[len] = 1;
+	bc_num_binTo(&r, tb, len + 1);
+
+	s = bc_num_mul(base, &r, &t, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	s = bc_num_rem(&t, m, &r, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	bc_num_binFrom(&r, pows, len);
+
+	if (w > 1) {
+
+		bc_num_binMontMul(x, pows, pows, mb, len, minv, tb);
+
+		for (i = 1; i < npows; ++i)
+			bc_num_binMontMul(pows + i * len, pows + (i - 1) * len, x, mb, len,
+			                  minv, tb);
 	}
 
-	if (BC_NUM_NONZERO(a) && !a->rdx && !b->rdx && b->len == 1 && !scale) {
+	for (i = 0; BC_NO_SIG && i < wins->len; i += 2) {
 
-		BcBigDig rem;
+		sqrs = *((size_t*) bc_vec_item(wins, i));
+		idx = *((size_t*) bc_vec_item(wins, i + 1));
 
-		s = bc_num_divArray(ptr_a, (BcBigDig) b->num[0], c, &rem);
+		if (!i) {
+			memcpy(x, pows + idx * len, len * sizeof(BcBinDig));
+			continue;
+		}
 
-		assert(rem < BC_BASE_POW);
+		for (k = 0; k < sqrs; ++k)
+			bc_num_binMontMul(x, x, x, mb, len, minv, tb);
 
-		d->num[0] = (BcDig) rem;
-		d->len = (rem != 0);
+		if (idx != BC_VEC_INVALID_IDX)
+			bc_num_binMontMul(x, x, pows + idx * len, mb, len, minv, tb);
 	}
-	else s = bc_num_r(ptr_a, b, c, d, scale, ts);
 
-	assert(!c->neg || BC_NUM_NONZERO(c));
-	assert(c->rdx <= c->len || !c->len);
-	assert(!c->len || c->num[c->len - 1] || c->rdx == c->len);
-	assert(!d->neg || BC_NUM_NONZERO(d));
-	assert(d->rdx <= d->len || !d->len);
-	assert(!d->len || d->num[d->len - 1] || d->rdx == d->len);
+	if (BC_SIG) {
+		s = BC_STATUS_SIGNAL;
+		goto err;
+	}
 
-	if (init) bc_num_free(&num2);
+	// Multiplying by 1 takes the result out of Montgomery form.
+	memset(pows, 0, len * sizeof(BcBinDig));
+	pows[0] = 1;
+	bc_num_binMontMul(x, x, pows, mb, len, minv, tb);
 
+	bc_num_binTo(d, x, len);
+
+	if (BC_SIG) s = BC_STATUS_SIGNAL;
+
+err:
+	bc_num_free(&t);
+	bc_num_free(&r);
+	free(pows);
+	free(mb);
 	return s;
 }
 
-#if DC_ENABLED
 BcStatus bc_num_modexp(BcNum *a, BcNum *b, BcNum *c, BcNum *restrict d) {
 
 	BcStatus s;
-	BcNum base, exp, two, temp;
-	BcDig two_digs[2];
+	BcNum base, m;
+	BcVec bits, wins;
+	size_t w;
+	uchar *bit;
 
 	assert(a != NULL && b != NULL && c != NULL && d != NULL);
 	assert(a != d && b != d && c != d);
@@ -2380,52 +5203,49 @@ BcStatus bc_num_modexp(BcNum *a, BcNum *b, BcNum *c, BcNum *restrict d) {
 		return bc_vm_err(BC_ERROR_MATH_NON_INTEGER);
 
 	bc_num_expand(d, c->len);
-	bc_num_init(&base, c->len);
-	bc_num_setup(&two, two_digs, sizeof(two_digs) / sizeof(BcDig));
-	bc_num_init(&temp, b->len + 1);
-
-	bc_num_one(&two);
-	two.num[0] = 2;
 	bc_num_one(d);
 
+	if (BC_NUM_ZERO(b)) return BC_STATUS_SUCCESS;
+
+	// The sign of the result only comes from a, as it would if every product
+	// was reduced with bc_num_rem(), so the work is done with magnitudes.
+	bc_num_move(&m, c);
+	m.neg = false;
+
+	bc_num_init(&base, c->len);
+	bc_vec_init(&bits, sizeof(uchar), NULL);
+	bc_vec_init(&wins, sizeof(size_t), NULL);
+
 	// We already checked for 0.
 	s = bc_num_rem(a, c, &base, 0);
 	assert(!s || s == BC_STATUS_SIGNAL);
-	if (BC_ERROR_SIGNAL_ONLY(s)) goto rem_err;
-	bc_num_createCopy(&exp, b);
-
-	while (BC_NO_SIG && BC_NUM_NONZERO(&exp)) {
-
-		// Num two cannot be 0, so no errors.
-		s = bc_num_divmod(&exp, &two, &exp, &temp, 0);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	base.neg = false;
 
-		if (BC_NUM_ONE(&temp) && !temp.neg) {
+	s = bc_num_modexpBits(b, &bits);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-			s = bc_num_mul(d, &base, &temp, 0);
-			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	// The window grows with the exponent because each extra bit doubles the
+	// number of odd powers that need to be precomputed.
+	for (w = 1; w < 6 && (((size_t) 1) << (2 * w)) < bits.len; ++w);
 
-			// We already checked for 0.
-			s = bc_num_rem(&temp, c, d, 0);
-			assert(!s || s == BC_STATUS_SIGNAL);
-			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-		}
+	bc_num_modexpWindows(&bits, w, &wins);
 
-		s = bc_num_mul(&base, &base, &temp, 0);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	// BC_BASE_POW is even, so the bottom limb has the parity of the modulus.
+	// Montgomery's reduction needs an odd one, and its schoolbook products
+	// lose to the fast multiplication of the decimal limbs past a point.
+	if ((m.num[0] & 1) && m.len < BC_NUM_MONT_LEN)
+		s = bc_num_modexpMont(&base, &m, &wins, w, d);
+	else s = bc_num_modexpBarrett(&base, &m, &wins, w, d);
 
-		// We already checked for 0.
-		s = bc_num_rem(&temp, c, &base, 0);
-		assert(!s || s == BC_STATUS_SIGNAL);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-	}
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+	bit = bc_vec_item(&bits, 0);
+	d->neg = (a->neg && *bit && BC_NUM_NONZERO(d));
 
 err:
-	bc_num_free(&exp);
-rem_err:
-	bc_num_free(&temp);
+	bc_vec_free(&wins);
+	bc_vec_free(&bits);
 	bc_num_free(&base);
 	assert(!d->neg || d->len);
 	assert(!d->len || d->num[d->len - 1] || d->rdx == d->len);
@@ -76,6 +76,7 @@ void bc_parse_addId(BcParse *p, const char *string, uchar inst) {
 
 			c.val = str;
 			c.base = BC_NUM_BIGDIG_MAX;
+			c.borrows = 0;
 
 			memset(&c.num, 0, sizeof(BcNum));
 			bc_vec_push(v, &c);
@@ -42,6 +42,7 @@
 #include <read.h>
 #include <parse.h>
 #include <program.h>
+#include <bc.h>
 #include <vm.h>
 
 #ifndef BC_PROG_NO_STACK_CHECK
@@ -87,11 +88,6 @@ static BcFunc* bc_program_func(const BcProgram *p) {
 	return bc_vec_item(&p->fns, i);
 }
 
-static BcConst* bc_program_const(const BcProgram *p, size_t idx) {
-	BcFunc *f = bc_program_func(p);
-	return bc_vec_item(&f->consts, idx);
-}
-
 static char* bc_program_str(const BcProgram *p, size_t idx) {
 	BcFunc *f = bc_program_func(p);
 	return *((char**) bc_vec_item(&f->strs, idx));
@@ -175,11 +171,31 @@ static BcStatus bc_program_num(BcProgram *p, BcResult *r, BcNum **num) {
 
 		case BC_RESULT_CONSTANT:
 		{
-			BcConst *c = bc_program_const(p, r->d.loc.loc);
+			BcConst *c = bc_result_const(&r->d.c);
 			BcBigDig base = BC_PROG_IBASE(p);
 
+			n = &c->num;
+
+			// Constants are borrowed, not copied. A borrowed result keeps the
+			// value it was read with, so a constant with borrows cannot be
+			// parsed again; a reader in another ibase gets a private copy.
+			if (r->d.c.borrowed) break;
+
 			if (c->base != base) {
 
+				if (c->borrows) {
+
+					n = &r->d.n;
+					r->t = BC_RESULT_TEMP;
+
+					bc_num_init(n, BC_NUM_RDX(strlen(c->val)));
+
+					s = bc_num_parse(n, c->val, base, !c->val[1]);
+					assert(!s || s == BC_STATUS_SIGNAL);
+
+					break;
+				}
+
 				if (c->num.num == NULL)
 					bc_num_init(&c->num, BC_NUM_RDX(strlen(c->val)));
 
@@ -196,10 +212,9 @@ static BcStatus bc_program_num(BcProgram *p, BcResult *r, BcNum **num) {
 				c->base = base;
 			}
 
-			n = &r->d.n;
-			bc_num_createCopy(n, &c->num);
+			r->d.c.borrowed = true;
+			c->borrows += 1;
 
-			r->t = BC_RESULT_TEMP;
 			break;
 		}
 
@@ -1020,6 +1035,82 @@ static BcStatus bc_program_incdec(BcProgram *p, uchar inst) {
 	return s;
 }
 
+// gcd() and lcm() are not keywords, so scripts can still define functions with
+// those names. Calls to them only get here if no such function is defined.
+static BcStatus bc_program_gcd(BcProgram *p, bool gcd) {
+
+	BcStatus s;
+	BcResult *opd1, *opd2, res;
+	BcNum *n1, *n2;
+	size_t i;
+
+	assert(BC_PROG_STACK(&p->results, 2));
+
+	for (i = 0; i < 2; ++i) {
+
+		BcResult *arg = bc_vec_item_rev(&p->results, i);
+
+		if (BC_ERR(arg->t == BC_RESULT_VOID))
+			return bc_vm_err(BC_ERROR_EXEC_VOID_VAL);
+		if (BC_ERR(arg->t == BC_RESULT_ARRAY))
+			return bc_vm_err(BC_ERROR_EXEC_TYPE);
+	}
+
+	s = bc_program_binOpPrep(p, &opd1, &n1, &opd2, &n2);
+	if (BC_ERR(s)) return s;
+	bc_num_init(&res.d.n, bc_vm_growSize(n1->len, n2->len));
+
+	if (gcd) s = bc_num_gcd(n1, n2, &res.d.n, 0);
+	else s = bc_num_lcm(n1, n2, &res.d.n, 0);
+	if (BC_ERR(s)) goto err;
+
+	bc_program_binOpRetire(p, &res);
+
+	return s;
+
+err:
+	bc_num_free(&res.d.n);
+	return s;
+}
+
+// The native versions of the math library functions do not report errors.
+// When one would happen, or when a parameter has the wrong type, this returns
+// BC_STATUS_ERROR_EXEC without doing anything, and the bc code runs instead.
+static BcStatus bc_program_callLib(BcProgram *p, size_t lib, size_t nparams) {
+
+	BcStatus s;
+	BcResult res, *arg;
+	BcNum *args[2];
+	size_t i;
+
+	assert(nparams <= 2 && BC_PROG_STACK(&p->results, nparams));
+
+	for (i = 0; i < nparams; ++i) {
+
+		arg = bc_vec_item_rev(&p->results, nparams - 1 - i);
+
+		if (arg->t == BC_RESULT_VOID || arg->t == BC_RESULT_ARRAY)
+			return BC_STATUS_ERROR_EXEC;
+
+		s = bc_program_num(p, arg, args + i);
+		if (BC_ERR(s)) return s;
+	}
+
+	bc_num_init(&res.d.n, BC_NUM_DEF_SIZE);
+
+	s = bc_lib_natives[lib](args, &res.d.n, BC_PROG_SCALE(p));
+	if (BC_ERR(s)) {
+		bc_num_free(&res.d.n);
+		return s;
+	}
+
+	res.t = BC_RESULT_TEMP;
+	bc_vec_npop(&p->results, nparams);
+	bc_vec_push(&p->results, &res);
+
+	return s;
+}
+
 static BcStatus bc_program_call(BcProgram *p, const char *restrict code,
                                 size_t *restrict idx)
 {
@@ -1036,10 +1127,25 @@ static BcStatus bc_program_call(BcProgram *p, const char *restrict code,
 	ip.func = bc_program_index(code, idx);
 	f = bc_vec_item(&p->fns, ip.func);
 
-	if (BC_ERR(!f->code.len))
+	if (!f->code.len) {
+
+		bool gcd = !strcmp(f->name, bc_func_gcd);
+
+		if (nparams == 2 && (gcd || !strcmp(f->name, bc_func_lcm)))
+			return bc_program_gcd(p, gcd);
+
 		return bc_vm_verr(BC_ERROR_EXEC_UNDEF_FUNC, f->name);
+	}
 	if (BC_ERR(nparams != f->nparams))
 		return bc_vm_verr(BC_ERROR_EXEC_PARAMS, f->nparams, nparams);
+
+	for (i = 0; i < BC_PROG_LIB_LEN && p->lib[i] != ip.func; ++i);
+
+	if (i < BC_PROG_LIB_LEN) {
+		s = bc_program_callLib(p, i, nparams);
+		if (s != BC_STATUS_ERROR_EXEC) return s;
+	}
+
 	ip.len = p->results.len - nparams;
 
 	assert(BC_PROG_STACK(&p->results, nparams));
@@ -1448,7 +1554,7 @@ static BcStatus bc_program_execStr(BcProgram *p, const char *restrict code,
 		then_idx = bc_program_index(code, bgn);
 		else_idx = bc_program_index(code, bgn);
 
-		exec = (r->d.n.len != 0);
+		exec = (n->len != 0);
 
 		if (exec) idx = then_idx;
 		else {
@@ -1566,6 +1672,7 @@ void bc_program_free(BcProgram *p) {
 
 	for (i = 0; i < BC_PROG_GLOBALS_LEN; ++i) bc_vec_free(p->globals_v + i);
 
+	bc_vec_free(&p->results);
 	bc_vec_free(&p->fns);
 #if BC_ENABLED
 	bc_vec_free(&p->fn_map);
@@ -1574,12 +1681,12 @@ void bc_program_free(BcProgram *p) {
 	bc_vec_free(&p->var_map);
 	bc_vec_free(&p->arrs);
 	bc_vec_free(&p->arr_map);
-	bc_vec_free(&p->results);
 	bc_vec_free(&p->stack);
 
 #if BC_ENABLED
 	if (BC_IS_BC) {
 		bc_num_free(&p->last);
+		for (i = 0; i < BC_PROG_CONSTS_LEN; ++i) bc_vec_free(p->consts + i);
 	}
 #endif // BC_ENABLED
 
@@ -1620,11 +1727,15 @@ void bc_program_init(BcProgram *p) {
 	}
 #endif // DC_ENABLED
 
-	bc_num_setup(&p->one, p->one_num, BC_PROG_ONE_CAP);
+	bc_num_init(&p->one, BC_NUM_DEF_SIZE);
 	bc_num_one(&p->one);
 
 #if BC_ENABLED
-	if (BC_IS_BC) bc_num_init(&p->last, BC_NUM_DEF_SIZE);
+	if (BC_IS_BC) {
+		bc_num_init(&p->last, BC_NUM_DEF_SIZE);
+		for (i = 0; i < BC_PROG_CONSTS_LEN; ++i)
+			bc_vec_init(p->consts + i, sizeof(BcNum), bc_num_free);
+	}
 #endif // BC_ENABLED
 
 	bc_vec_init(&p->fns, sizeof(BcFunc), bc_func_free);
@@ -1657,6 +1768,41 @@ void bc_program_addFunc(BcProgram *p, BcFunc *f, const char *name) {
 }
 
 #if BC_ENABLED
+void bc_program_lib(BcProgram *p) {
+
+	BcId id;
+	char name[2];
+	size_t i, idx;
+
+	name[1] = '\0';
+	id.name = name;
+
+	for (i = 0; i < BC_PROG_LIB_LEN; ++i) {
+
+		name[0] = bc_lib_fns[i];
+		idx = bc_map_index(&p->fn_map, &id);
+
+		if (idx != BC_VEC_INVALID_IDX)
+			p->lib[i] = ((BcId*) bc_vec_item(&p->fn_map, idx))->idx;
+	}
+}
+
+static void bc_program_unlib(BcProgram *p, size_t idx) {
+
+	size_t i, j;
+
+	for (i = 0; i < BC_PROG_LIB_LEN; ++i) {
+
+		if (p->lib[i] != idx) continue;
+
+		// The native versions that call the redefined function have to stop
+		// too, so that the bc code calls the new one.
+		for (j = 0; j < BC_PROG_LIB_LEN; ++j) {
+			if (j == i || (bc_lib_calls[j] & (1 << i))) p->lib[j] = 0;
+		}
+	}
+}
+
 size_t bc_program_insertFunc(BcProgram *p, char *name) {
 
 	BcId id;
@@ -1675,6 +1821,7 @@ size_t bc_program_insertFunc(BcProgram *p, char *name) {
 	if (!new) {
 		BcFunc *func = bc_vec_item(&p->fns, idx);
 		bc_func_reset(func);
+		bc_program_unlib(p, idx);
 		free(name);
 	}
 	else bc_program_addFunc(p, &f, name);
@@ -1695,6 +1842,8 @@ BcStatus bc_program_reset(BcProgram *p, BcStatus s) {
 	ip = bc_vec_top(&p->stack);
 	ip->idx = f->code.len;
 
+	bc_vm_arenaReset();
+
 #if BC_ENABLE_SIGNALS
 	if (BC_SIGTERM || (!s && BC_SIGINT && BC_I)) return BC_STATUS_QUIT;
 
@@ -1862,7 +2011,9 @@ BcStatus bc_program_exec(BcProgram *p) {
 			case BC_INST_NUM:
 			{
 				r.t = BC_RESULT_CONSTANT;
-				r.d.loc.loc = bc_program_index(code, &ip->idx);
+				r.d.c.func = BC_IS_BC ? ip->func : BC_PROG_MAIN;
+				r.d.c.idx = bc_program_index(code, &ip->idx);
+				r.d.c.borrowed = false;
 				bc_vec_push(&p->results, &r);
 				break;
 			}
@@ -2035,6 +2186,8 @@ BcStatus bc_program_exec(BcProgram *p) {
 				memcpy(&r, ptr, sizeof(BcResult));
 				memcpy(ptr, ptr2, sizeof(BcResult));
 				memcpy(ptr2, &r, sizeof(BcResult));
+				bc_result_moved(ptr);
+				bc_result_moved(ptr2);
 
 				break;
 			}
@@ -2147,7 +2300,7 @@ void bc_program_printInst(const BcProgram *p, const char *restrict code,
 	else if (inst == BC_INST_STR) bc_program_printStr(p, code, bgn);
 	else if (inst == BC_INST_NUM) {
 		size_t idx = bc_program_index(code, bgn);
-		BcConst *c = bc_program_const(p, idx);
+		BcConst *c = bc_vec_item(&bc_program_func(p)->consts, idx);
 		bc_vm_printf("(%s)", c->val);
 	}
 	else if (inst == BC_INST_CALL ||
@@ -0,0 +1,178 @@
+/*
+ * *****************************************************************************
+ *
+ * Copyright (c) 2018-2019 Gavin D. Howard and contributors.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * Code for the thread pool that big multiplications are split across.
+ *
+ */
+
+#if BC_ENABLE_THREADS
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <signal.h>
+
+#include <pthread.h>
+
+#include <status.h>
+#include <thread.h>
+#include <vm.h>
+
+// This must be called, and returns, with the lock held.
+static void bc_thread_exec(BcThreadPool *p) {
+
+	BcThreadTask *t = p->tasks;
+
+	p->tasks = t->next;
+
+	pthread_mutex_unlock(&p->lock);
+	t->s = t->func(t->data);
+	pthread_mutex_lock(&p->lock);
+
+	t->done = true;
+	pthread_cond_broadcast(&p->done);
+}
+
+static void* bc_thread_worker(void *data) {
+
+	BcThreadPool *p = (BcThreadPool*) data;
+
+	pthread_mutex_lock(&p->lock);
+
+	while (!p->stop) {
+		if (p->tasks != NULL) bc_thread_exec(p);
+		else pthread_cond_wait(&p->work, &p->lock);
+	}
+
+	pthread_mutex_unlock(&p->lock);
+
+	return NULL;
+}
+
+void bc_thread_init(BcThreadPool *p, size_t threads) {
+
+	sigset_t all, old;
+	size_t i;
+
+	assert(p != NULL && threads > 1);
+
+	pthread_mutex_init(&p->lock, NULL);
+	pthread_cond_init(&p->work, NULL);
+	pthread_cond_init(&p->done, NULL);
+
+	p->tasks = NULL;
+	p->stop = false;
+
+	// The thread that calls bc_thread_run() is one of the threads too.
+	p->threads = bc_vm_malloc(bc_vm_arraySize(threads - 1, sizeof(pthread_t)));
+
+	// The workers start with every signal blocked, so signals always go to the
+	// main thread. The workers see them through BC_SIG, like everything else.
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+
+	// If a thread cannot be started, there are just fewer of them; with none,
+	// bc_thread_run() runs everything on the calling thread.
+	for (i = 0; i < threads - 1; ++i) {
+		if (pthread_create(p->threads + i, NULL, bc_thread_worker, p)) break;
+	}
+
+	p->len = i;
+
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+void bc_thread_free(BcThreadPool *p) {
+
+	size_t i;
+
+	assert(p != NULL);
+
+	pthread_mutex_lock(&p->lock);
+	p->stop = true;
+	pthread_cond_broadcast(&p->work);
+	pthread_mutex_unlock(&p->lock);
+
+	for (i = 0; i < p->len; ++i) {
+		if (!pthread_equal(p->threads[i], pthread_self()))
+			pthread_join(p->threads[i], NULL);
+	}
+
+	pthread_cond_destroy(&p->done);
+	pthread_cond_destroy(&p->work);
+	pthread_mutex_destroy(&p->lock);
+
+	free(p->threads);
+}
+
+BcStatus bc_thread_run(BcThreadPool *p, BcThreadTask *tasks, size_t len) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	size_t i;
+
+	assert(p != NULL && tasks != NULL && len);
+
+	pthread_mutex_lock(&p->lock);
+
+	// The tasks go on the front of the queue, and the first is run right here.
+	// The ones that were queued last come off first, so the most recently
+	// split (and smallest) tasks are run before older, bigger ones.
+	for (i = len - 1; i < len; --i) {
+		tasks[i].done = false;
+		tasks[i].next = p->tasks;
+		p->tasks = tasks + i;
+	}
+
+	if (len > 1) pthread_cond_broadcast(&p->work);
+
+	bc_thread_exec(p);
+
+	// Instead of sleeping while the workers have its tasks, this thread runs
+	// whatever is still queued, which includes its own tasks if no worker took
+	// them. It only sleeps when the queue is empty, which means that every task
+	// it is waiting on is running on another thread. That is also why a task
+	// can call this function again without deadlocking.
+	for (i = 1; i < len; ++i) {
+		while (!tasks[i].done) {
+			if (p->tasks != NULL) bc_thread_exec(p);
+			else pthread_cond_wait(&p->done, &p->lock);
+		}
+	}
+
+	pthread_mutex_unlock(&p->lock);
+
+	for (i = 0; BC_NO_ERR(!s) && i < len; ++i) s = tasks[i].s;
+
+	return s;
+}
+
+#endif // BC_ENABLE_THREADS
@@ -42,6 +42,26 @@
 #include <lang.h>
 #include <vm.h>
 
+// Numbers can point into themselves, at their inline digits, so the vectors
+// that hold them have to repoint them when they move elements.
+static void bc_vec_moved(const BcVec *restrict v, size_t idx, size_t n) {
+
+	size_t i;
+
+	if (v->dtor == bc_num_free) {
+		BcNum *nums = (BcNum*) (v->v + v->size * idx);
+		for (i = 0; i < n; ++i) BC_NUM_MOVED(nums + i);
+	}
+	else if (v->dtor == bc_result_free) {
+		BcResult *res = (BcResult*) (v->v + v->size * idx);
+		for (i = 0; i < n; ++i) bc_result_moved(res + i);
+	}
+	else if (v->dtor == bc_const_free) {
+		BcConst *consts = (BcConst*) (v->v + v->size * idx);
+		for (i = 0; i < n; ++i) BC_NUM_MOVED(&consts[i].num);
+	}
+}
+
 static void bc_vec_grow(BcVec *restrict v, size_t n) {
 
 	size_t len, cap = v->cap;
@@ -52,6 +72,8 @@ static void bc_vec_grow(BcVec *restrict v, size_t n) {
 
 	v->v = bc_vm_realloc(v->v, bc_vm_arraySize(cap, v->size));
 	v->cap = cap;
+
+	bc_vec_moved(v, 0, v->len);
 }
 
 void bc_vec_init(BcVec *restrict v, size_t esize, BcVecFree dtor) {
@@ -68,6 +90,7 @@ void bc_vec_expand(BcVec *restrict v, size_t req) {
 	if (v->cap < req) {
 		v->v = bc_vm_realloc(v->v, bc_vm_arraySize(req, v->size));
 		v->cap = req;
+		bc_vec_moved(v, 0, v->len);
 	}
 }
 
@@ -84,6 +107,7 @@ void bc_vec_npush(BcVec *restrict v, size_t n, const void *data) {
 	assert(v != NULL && data != NULL);
 	if (v->len + n > v->cap) bc_vec_grow(v, n);
 	memcpy(v->v + (v->size * v->len), data, v->size * n);
+	bc_vec_moved(v, v->len, n);
 	v->len += n;
 }
 
@@ -128,6 +152,7 @@ static void bc_vec_pushAt(BcVec *restrict v, const void *data, size_t idx) {
 
 		memmove(ptr + v->size, ptr, v->size * (v->len++ - idx));
 		memmove(ptr, data, v->size);
+		bc_vec_moved(v, idx, v->len - idx);
 	}
 }
 
@@ -162,7 +187,6 @@ void bc_vec_empty(BcVec *restrict v) {
 	bc_vec_pushByte(v, '\0');
 }
 
-#if BC_ENABLE_HISTORY
 void bc_vec_popAt(BcVec *restrict v, size_t idx) {
 
 	char* ptr, *data;
@@ -176,9 +200,11 @@ void bc_vec_popAt(BcVec *restrict v, size_t idx) {
 	if (v->dtor != NULL) v->dtor(ptr);
 
 	v->len -= 1;
-	memmove(ptr, data, v->len * v->size);
+	memmove(ptr, data, (v->len - idx) * v->size);
+	bc_vec_moved(v, idx, v->len - idx);
 }
 
+#if BC_ENABLE_HISTORY
 void bc_vec_replaceAt(BcVec *restrict v, size_t idx, const void *data) {
 
 	char *ptr;
@@ -189,6 +215,7 @@ void bc_vec_replaceAt(BcVec *restrict v, size_t idx, const void *data) {
 
 	if (v->dtor != NULL) v->dtor(ptr);
 	memcpy(ptr, data, v->size);
+	bc_vec_moved(v, idx, 1);
 }
 #endif // BC_ENABLE_HISTORY
 
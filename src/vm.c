@@ -225,6 +225,79 @@ static size_t bc_vm_envLen(const char *var) {
 	return len;
 }
 
+static size_t bc_vm_envThreads(const char *var) {
+
+	char *tenv = getenv(var);
+	size_t threads;
+
+	if (tenv == NULL) return 1;
+
+	threads = bc_args_threads(tenv);
+
+	return threads ? threads : 1;
+}
+
+#if BC_ENABLED
+static size_t bc_vm_envSplit(const char *var) {
+
+	char *senv = getenv(var);
+	size_t i, len;
+	int num;
+
+	if (senv == NULL) return SIZE_MAX;
+
+	len = strlen(senv);
+
+	for (num = (len != 0), i = 0; num && i < len; ++i) num = isdigit(senv[i]);
+
+	return num ? (size_t) strtoul(senv, NULL, 10) : SIZE_MAX;
+}
+#endif // BC_ENABLED
+
+static void bc_vm_poolLock(void) {
+#if BC_ENABLE_THREADS
+	// Numbers are only made and freed on other threads if there are any.
+	if (vm->pool.len) pthread_mutex_lock(&vm->digs_lock);
+#endif // BC_ENABLE_THREADS
+}
+
+static void bc_vm_poolUnlock(void) {
+#if BC_ENABLE_THREADS
+	if (vm->pool.len) pthread_mutex_unlock(&vm->digs_lock);
+#endif // BC_ENABLE_THREADS
+}
+
+#ifndef NDEBUG
+static void bc_vm_poolRelease(void) {
+
+	size_t i;
+
+	for (i = 0; i < BC_VM_POOL_CLASSES; ++i) {
+		while (vm->digs[i] != NULL) {
+			void *ptr = vm->digs[i];
+			vm->digs[i] = *((void**) ptr);
+			free(ptr);
+		}
+	}
+}
+#endif // NDEBUG
+
+static void bc_vm_poolDump(void) {
+
+	size_t i;
+
+	for (i = 0; i < BC_VM_POOL_CLASSES; ++i) {
+
+		size_t hits = vm->digs_hits[i], misses = vm->digs_misses[i];
+
+		if (!hits && !misses) continue;
+
+		fprintf(stderr, "pool %8lu: %lu hits, %lu misses\n",
+		        (unsigned long) BC_VM_POOL_SIZE(i), (unsigned long) hits,
+		        (unsigned long) misses);
+	}
+}
+
 void bc_vm_shutdown(void) {
 #if BC_ENABLE_NLS
 	if (vm->catalog != BC_VM_INVALID_CATALOG) catclose(vm->catalog);
@@ -233,11 +306,20 @@ void bc_vm_shutdown(void) {
 	// This must always run to ensure that the terminal is back to normal.
 	bc_history_free(&vm->history);
 #endif // BC_ENABLE_HISTORY
+	if (vm->digs_stats) bc_vm_poolDump();
 #ifndef NDEBUG
+#if BC_ENABLE_THREADS
+	if (vm->pool.threads != NULL) bc_thread_free(&vm->pool);
+#endif // BC_ENABLE_THREADS
 	bc_vec_free(&vm->files);
 	bc_vec_free(&vm->exprs);
 	bc_program_free(&vm->prog);
 	bc_parse_free(&vm->prs);
+	bc_vm_poolRelease();
+	free(vm->arena);
+#if BC_ENABLE_THREADS
+	if (vm->pool.threads != NULL) pthread_mutex_destroy(&vm->digs_lock);
+#endif // BC_ENABLE_THREADS
 	free(vm);
 #endif // NDEBUG
 }
@@ -274,6 +356,134 @@ void* bc_vm_realloc(void *ptr, size_t n) {
 	return temp;
 }
 
+void* bc_vm_poolAlloc(size_t *n) {
+
+	void *ptr;
+	size_t i;
+
+	for (i = 0; i < BC_VM_POOL_CLASSES && BC_VM_POOL_SIZE(i) < *n; ++i);
+
+	if (i == BC_VM_POOL_CLASSES) return bc_vm_malloc(*n);
+
+	*n = BC_VM_POOL_SIZE(i);
+
+	bc_vm_poolLock();
+
+	ptr = vm->digs[i];
+	if (ptr != NULL) vm->digs[i] = *((void**) ptr);
+
+	if (ptr != NULL) vm->digs_hits[i] += 1;
+	else vm->digs_misses[i] += 1;
+
+	bc_vm_poolUnlock();
+
+	return ptr != NULL ? ptr : bc_vm_malloc(*n);
+}
+
+void* bc_vm_poolRealloc(void *ptr, size_t old, size_t *n) {
+
+	void *temp;
+
+	assert(old <= *n);
+
+	if (ptr == NULL) return bc_vm_poolAlloc(n);
+
+	// Buffers too big for the pool stay too big for it.
+	if (old > BC_VM_POOL_SIZE(BC_VM_POOL_CLASSES - 1))
+		return bc_vm_realloc(ptr, *n);
+
+	temp = bc_vm_poolAlloc(n);
+	memcpy(temp, ptr, old);
+	bc_vm_poolFree(ptr, old);
+
+	return temp;
+}
+
+void bc_vm_poolFree(void *ptr, size_t n) {
+
+	size_t i;
+
+	if (ptr == NULL) return;
+
+	for (i = 0; i < BC_VM_POOL_CLASSES && BC_VM_POOL_SIZE(i) < n; ++i);
+
+	if (i == BC_VM_POOL_CLASSES) {
+		free(ptr);
+		return;
+	}
+
+	assert(n == BC_VM_POOL_SIZE(i));
+
+	bc_vm_poolLock();
+
+	*((void**) ptr) = vm->digs[i];
+	vm->digs[i] = ptr;
+
+	bc_vm_poolUnlock();
+}
+
+static void bc_vm_arenaGrow(void) {
+
+	size_t cap;
+
+	assert(!vm->arena_len);
+
+	for (cap = BC_VM_POOL_MIN; cap < vm->arena_need; cap *= 2);
+	cap = BC_MIN(cap, BC_VM_ARENA_MAX);
+
+	if (cap <= vm->arena_cap) return;
+
+	free(vm->arena);
+	vm->arena = bc_vm_malloc(cap);
+	vm->arena_cap = cap;
+}
+
+void* bc_vm_arenaAlloc(size_t *n) {
+
+	void *ptr;
+	size_t len;
+
+#if BC_ENABLE_THREADS
+	// The arena is a stack, and other threads would not pop in order.
+	if (vm->pool.len) return NULL;
+#endif // BC_ENABLE_THREADS
+
+	if (*n > BC_VM_ARENA_MAX) return NULL;
+
+	*n = (*n + BC_VM_ARENA_ALIGN - 1) & ~((size_t) BC_VM_ARENA_ALIGN - 1);
+	len = vm->arena_len + *n;
+
+	if (len > vm->arena_cap) {
+
+		vm->arena_need = BC_MAX(vm->arena_need, len);
+
+		// Nothing can be moved while scratch numbers are using the arena, but
+		// when it is empty, it can grow to what was needed so far.
+		if (!vm->arena_len) bc_vm_arenaGrow();
+		if (len > vm->arena_cap) return NULL;
+	}
+
+	ptr = vm->arena + vm->arena_len;
+	vm->arena_len = len;
+
+	return ptr;
+}
+
+void bc_vm_arenaRelease(size_t mark) {
+
+#if BC_ENABLE_THREADS
+	if (vm->pool.len) return;
+#endif // BC_ENABLE_THREADS
+
+	assert(mark <= vm->arena_len);
+
+	vm->arena_len = mark;
+}
+
+void bc_vm_arenaReset(void) {
+	vm->arena_len = 0;
+}
+
 char* bc_vm_strdup(const char *str) {
 	char *s = strdup(str);
 	if (BC_ERR(!s)) bc_vm_exit(BC_ERROR_FATAL_ALLOC_ERR);
@@ -317,6 +527,8 @@ static void bc_vm_clean(void) {
 	BcInstPtr *ip = bc_vec_item(&prog->stack, 0);
 	bool good = false;
 
+	bc_vm_arenaReset();
+
 #if BC_ENABLED
 	if (BC_IS_BC) good = !BC_PARSE_NO_EXEC(&vm->prs);
 #endif // BC_ENABLED
@@ -598,6 +810,8 @@ static BcStatus bc_vm_exec(const char* env_exp_exit) {
 		s = bc_vm_load(bc_lib_name, bc_lib);
 		if (BC_ERR(s)) return s;
 
+		bc_program_lib(&vm->prog);
+
 #if BC_ENABLE_EXTRA_MATH
 		if (!BC_IS_POSIX) {
 			s = bc_vm_load(bc_lib2_name, bc_lib2);
@@ -628,7 +842,9 @@ static BcStatus bc_vm_exec(const char* env_exp_exit) {
 }
 
 BcStatus bc_vm_boot(int argc, char *argv[], const char *env_len,
-                    const char* const env_args, const char* env_exp_exit)
+                    const char* const env_args, const char* env_exp_exit,
+                    const char *env_threads, const char *env_stats,
+                    const char *env_kernels)
 {
 	BcStatus s;
 	int ttyin, ttyout, ttyerr;
@@ -649,10 +865,13 @@ BcStatus bc_vm_boot(int argc, char *argv[], const char *env_len,
 #endif // BC_ENABLE_SIGNALS
 
 	vm->file = NULL;
+	vm->kernels = bc_num_kernels(getenv(env_kernels));
 
 	bc_vm_gettext();
 
 	vm->line_len = (uint16_t) bc_vm_envLen(env_len);
+	vm->threads = bc_vm_envThreads(env_threads);
+	vm->digs_stats = (getenv(env_stats) != NULL);
 
 	bc_vec_init(&vm->files, sizeof(char*), NULL);
 	bc_vec_init(&vm->exprs, sizeof(uchar), NULL);
@@ -665,7 +884,10 @@ BcStatus bc_vm_boot(int argc, char *argv[], const char *env_len,
 #endif // BC_ENABLE_HISTORY
 
 #if BC_ENABLED
-	if (BC_IS_BC) vm->flags |= BC_FLAG_S * (getenv("POSIXLY_CORRECT") != NULL);
+	if (BC_IS_BC) {
+		vm->flags |= BC_FLAG_S * (getenv("POSIXLY_CORRECT") != NULL);
+		vm->split = bc_vm_envSplit("BC_SPLIT_SCALE");
+	}
 #endif // BC_ENABLED
 
 	s = bc_vm_envArgs(env_args);
@@ -694,6 +916,13 @@ BcStatus bc_vm_boot(int argc, char *argv[], const char *env_len,
 
 	if (BC_IS_BC && BC_I && !(vm->flags & BC_FLAG_Q)) bc_vm_info(NULL);
 
+#if BC_ENABLE_THREADS
+	if (vm->threads > 1) {
+		pthread_mutex_init(&vm->digs_lock, NULL);
+		bc_thread_init(&vm->pool, vm->threads);
+	}
+#endif // BC_ENABLE_THREADS
+
 	s = bc_vm_exec(env_exp_exit);
 
 exit:
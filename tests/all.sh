@@ -105,6 +105,29 @@ done < "$testdir/$d/all.txt"
 sh "$testdir/stdin.sh" "$d" "$exe" "$@"
 
 sh "$testdir/scripts.sh" "$d" "$run_stack_tests" "$generate_tests" "$time_tests" "$exe" "$@"
+
+# The scripts above only run the best kernels that this machine has, so run the
+# ones that use the kernels the most with each of the others too.
+if [ "$d" = "bc" ]; then
+
+	for k in scalar avx2; do
+
+		v=$(BC_KERNELS="$k" "$exe" "$@" -v | sed -n 's/^Kernels: //p')
+
+		if [ "$v" != "$k" ]; then
+			continue
+		fi
+
+		printf 'Using %s kernels\n' "$k"
+
+		for s in bigadd.bc bigmul.bc; do
+			BC_KERNELS="$k" sh "$testdir/script.sh" "$d" "$s" "$run_stack_tests" \
+				"$generate_tests" "$time_tests" "$exe" "$@"
+		done
+
+	done
+
+fi
 sh "$testdir/read.sh" "$d" "$exe" "$@"
 sh "$testdir/errors.sh" "$d" "$exe" "$@"
 